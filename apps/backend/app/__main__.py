@@ -13,6 +13,11 @@ if __name__ == "__main__":
         "app.main:app",
         host=host,
         port=port,
-        reload=os.getenv("RELOAD", "false").lower() == "true"
+        reload=os.getenv("RELOAD", "false").lower() == "true",
+        # The board uploads every 30 seconds over a single persistent HTTPS
+        # connection, so idle connections must outlive the upload interval
+        timeout_keep_alive=int(os.getenv("KEEP_ALIVE_TIMEOUT", "65")),
+        # Optional TLS termination for local testing (e.g. scripts/bench_upload.py)
+        ssl_keyfile=os.getenv("SSL_KEYFILE"),
+        ssl_certfile=os.getenv("SSL_CERTFILE"),
     )
-
@@ -0,0 +1,137 @@
+"""
+Bucketed storage layout for sensor readings.
+
+Instead of one document per reading, readings are appended to one document
+per device per hour. Each column (timestamp, ingest metadata, every registry
+field) is an array, and all arrays grow together, so index i across the
+columns is reading i. The bucket also keeps min/max for every scalar value
+and vector axis, updated with $min/$max as readings arrive.
+
+Every reading keeps its own ObjectId in the `_id` column, and a unique
+multikey index on it rejects a reading that is already stored, e.g. when the
+write-ahead log replays a write that succeeded. Sequence numbers are also
+collected in a `seqs` array holding only the readings that carry one. A
+unique multikey index on (device_id, seqs) then rejects a reading whose seq
+is already stored in any bucket.
+
+Readings are only appended to a device's open bucket for the hour. A unique
+index on (device_id, hour) over open buckets keeps concurrent writers from
+opening two; a full bucket, or one with outdated columns, is closed before
+the next is opened.
+"""
+from collections import defaultdict
+from datetime import datetime, timedelta
+from typing import List, Tuple
+from bson import ObjectId
+from app.models.registry import SENSOR_FIELDS
+from app.models.sensor import DEFAULT_DEVICE_ID
+from app.services.aggregates import scalar_values
+
+STORAGE_LAYOUT_DOCUMENTS = "documents"
+STORAGE_LAYOUT_BUCKETS = "buckets"
+
+BUCKET_SPAN = timedelta(hours=1)
+# Readings per bucket before another one is opened for the same device and hour,
+# keeping documents far below MongoDB's 16 MB limit at high sample rates
+BUCKET_MAX_READINGS = 3600
+
+# Per-reading columns. A bucket records the columns it was created with, so a
+# registry change opens new buckets instead of misaligning the arrays of open ones
+BUCKET_COLUMNS = [
+    "_id",
+    "timestamp",
+    "received_at",
+    "device_timestamp",
+    "sample_rates_hz",
+    "report_interval_s",
+    "seq",
+    *(field.name for field in SENSOR_FIELDS),
+]
+
+
+def bucket_hour(timestamp: datetime) -> datetime:
+    return timestamp.replace(minute=0, second=0, microsecond=0)
+
+
+def bucket_filter(device_id: str, hour: datetime, size: int, ids: List[ObjectId], seqs: List[int] = ()) -> dict:
+    """Filter matching the open bucket for a device and hour if it has room for
+    `size` more readings, used with upsert. A bucket already holding one of
+    `ids` or `seqs` does not match either, so the upsert tries to open a new
+    bucket and a unique index reports the conflict. (Unique indexes do not
+    catch a value repeated within one document.)"""
+    query = {
+        "device_id": device_id,
+        "hour": hour,
+        "open": True,
+        "columns": BUCKET_COLUMNS,
+        "count": {"$lte": BUCKET_MAX_READINGS - size},
+        "samples._id": {"$nin": list(ids)},
+    }
+    if seqs:
+        query["seqs"] = {"$nin": list(seqs)}
+    return query
+
+
+def full_bucket_filter(device_id: str, hour: datetime, size: int) -> dict:
+    """Filter matching the open bucket for a device and hour if no more readings
+    can be appended to it: it has no room for `size` readings, or its columns
+    are outdated"""
+    return {
+        "device_id": device_id,
+        "hour": hour,
+        "open": True,
+        "$or": [{"count": {"$gt": BUCKET_MAX_READINGS - size}}, {"columns": {"$ne": BUCKET_COLUMNS}}],
+    }
+
+
+def bucket_update(documents: List[dict]) -> dict:
+    """Update appending reading documents (as built for the document layout) to a bucket"""
+    update = {
+        "$push": {f"samples.{column}": {"$each": [document.get(column) for document in documents]} for column in BUCKET_COLUMNS},
+        "$inc": {"count": len(documents)},
+        "$min": {"start": min(document["timestamp"] for document in documents)},
+        "$max": {"end": max(document["timestamp"] for document in documents)},
+    }
+    seqs = document_seqs(documents)
+    if seqs:
+        update["$push"]["seqs"] = {"$each": seqs}
+    for document in documents:
+        for key, (value, _) in scalar_values(document).items():
+            update["$min"][f"min.{key}"] = min(value, update["$min"].get(f"min.{key}", value))
+            update["$max"][f"max.{key}"] = max(value, update["$max"].get(f"max.{key}", value))
+    return update
+
+
+def document_seqs(documents: List[dict]) -> List[int]:
+    return [document["seq"] for document in documents if document.get("seq") is not None]
+
+
+def group_by_bucket(documents: List[dict]) -> List[Tuple[str, datetime, List[dict]]]:
+    """Reading documents grouped into (device_id, hour, documents) per bucket,
+    in chunks of at most BUCKET_MAX_READINGS"""
+    groups = defaultdict(list)
+    for document in documents:
+        groups[(document.get("device_id", DEFAULT_DEVICE_ID), bucket_hour(document["timestamp"]))].append(document)
+    return [
+        (device_id, hour, group[offset:offset + BUCKET_MAX_READINGS])
+        for (device_id, hour), group in groups.items()
+        for offset in range(0, len(group), BUCKET_MAX_READINGS)
+    ]
+
+
+def reading_id(bucket_id, index: int) -> str:
+    """Id of a reading in a bucket written before readings kept their own _id"""
+    return f"{bucket_id}:{index}"
+
+
+def unpack_bucket(bucket: dict) -> List[dict]:
+    """Reading documents stored in a bucket, in the document layout's shape"""
+    samples = bucket["samples"]
+    readings = []
+    for index in range(len(samples["timestamp"])):
+        reading = {"_id": reading_id(bucket["_id"], index), "device_id": bucket["device_id"]}
+        for column, values in samples.items():
+            if values[index] is not None:
+                reading[column] = values[index]
+        readings.append(reading)
+    return readings
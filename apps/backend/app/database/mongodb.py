@@ -2,12 +2,34 @@ import os
 import asyncio
 import logging
 from motor.motor_asyncio import AsyncIOMotorClient
-from typing import List, Optional
+from pymongo import ReturnDocument
+from pymongo.errors import BulkWriteError, DuplicateKeyError, PyMongoError
+from typing import Awaitable, Callable, List, Optional, TypeVar
 from datetime import datetime
-from app.models.sensor import SensorDataInput, SensorDataOutput
+from app.models.registry import SENSOR_FIELD_NAMES
+from app.models.sensor import DEFAULT_DEVICE_ID, SensorDataInput, SensorDataOutput, TimestampedSensorDataInput
+from app.models.telemetry import TelemetryInput, TelemetryOutput
+from app.models.events import ImuEventInput, ImuEventOutput
+from app.services.clock_sync import ClockSync, to_naive_utc
+from app.services.dedupe import SequenceWindows
+from app.services.wal import IngestLog
+from app.database.buckets import (
+    STORAGE_LAYOUT_BUCKETS, STORAGE_LAYOUT_DOCUMENTS, BUCKET_SPAN,
+    bucket_filter, bucket_hour, bucket_update, document_seqs, full_bucket_filter, group_by_bucket, unpack_bucket,
+)
 
 logger = logging.getLogger(__name__)
 
+T = TypeVar("T")
+
+DUPLICATE_KEY_ERROR = 11000
+# With the write-ahead log to fall back on, a write to an unreachable server fails
+# after this long instead of the driver's default 30 seconds
+WAL_SERVER_SELECTION_TIMEOUT_MS = 2000
+# Input fields that are not sensor values; excluding these is cheaper for
+# pydantic's serializer than including every sensor field by name
+_METADATA_FIELDS = frozenset(SensorDataInput.model_fields) - SENSOR_FIELD_NAMES
+
 
 class MongoDB:
     client: Optional[AsyncIOMotorClient] = None
@@ -15,6 +37,8 @@ class MongoDB:
     _connection_lock: Optional[asyncio.Lock] = None
     _lock_loop_id: Optional[int] = None
     _client_loop_id: Optional[int] = None
+    # "documents": one document per reading; "buckets": per-device-per-hour bucket documents
+    storage_layout: str = STORAGE_LAYOUT_DOCUMENTS
 
     @classmethod
     async def _get_connection_lock(cls) -> asyncio.Lock:
@@ -49,6 +73,11 @@ class MongoDB:
         if not mongodb_url:
             raise ValueError("MONGODB_URL environment variable is not set")
         
+        storage_layout = os.getenv("STORAGE_LAYOUT", STORAGE_LAYOUT_DOCUMENTS)
+        if storage_layout not in (STORAGE_LAYOUT_DOCUMENTS, STORAGE_LAYOUT_BUCKETS):
+            raise ValueError(f"STORAGE_LAYOUT must be '{STORAGE_LAYOUT_DOCUMENTS}' or '{STORAGE_LAYOUT_BUCKETS}'")
+        cls.storage_layout = storage_layout
+        
         # Get current event loop ID
         try:
             current_loop = asyncio.get_running_loop()
@@ -65,7 +94,8 @@ class MongoDB:
             cls.client = None
             cls.database = None
         
-        cls.client = AsyncIOMotorClient(mongodb_url)
+        client_options = {"serverSelectionTimeoutMS": WAL_SERVER_SELECTION_TIMEOUT_MS} if IngestLog.enabled() else {}
+        cls.client = AsyncIOMotorClient(mongodb_url, **client_options)
         cls.database = cls.client[db_name]
         cls._client_loop_id = current_loop_id
         
@@ -100,9 +130,53 @@ class MongoDB:
                 logger.info(f"Index on 'timestamp' field created/verified")
             except Exception as index_error:
                 logger.warning(f"Could not create index on 'timestamp': {str(index_error)}")
+            
+            # Telemetry records and IMU events live in their own collections, queried newest first
+            for events_collection in ("device_telemetry", "imu_events"):
+                try:
+                    await cls.database[events_collection].create_index("timestamp")
+                except Exception as index_error:
+                    logger.warning(f"Could not create index on '{events_collection}.timestamp': {str(index_error)}")
+            
+            # Device-scoped reads filter on device_id and sort on timestamp, so they
+            # stay an index range scan however many devices share the collection
+            for device_collection in (collection_name, "device_telemetry", "imu_events"):
+                try:
+                    await cls.database[device_collection].create_index([("device_id", 1), ("timestamp", 1)])
+                except Exception as index_error:
+                    logger.warning(f"Could not create index on '{device_collection}.(device_id, timestamp)': {str(index_error)}")
+            
+            # Sequence numbers are unique per device, so retried and replayed readings are rejected
+            try:
+                await cls.database[collection_name].create_index(
+                    [("device_id", 1), ("seq", 1)], unique=True, partialFilterExpression={"seq": {"$exists": True}}
+                )
+                await cls.database.sensor_buckets.create_index(
+                    [("device_id", 1), ("seqs", 1)], unique=True, partialFilterExpression={"seqs": {"$exists": True}}
+                )
+                # Readings in buckets keep their _id, so a replayed reading is rejected like in sensor_readings
+                await cls.database.sensor_buckets.create_index(
+                    "samples._id", unique=True, partialFilterExpression={"samples._id": {"$exists": True}}
+                )
+            except Exception as index_error:
+                logger.warning(f"Could not create unique sequence indexes: {str(index_error)}")
+            
+            # Bucket documents are looked up by device and hour on write, and by hour on read.
+            # Both layouts are always read, so the indexes exist whichever one is written.
+            # Only one bucket per device and hour is open for writes
+            try:
+                await cls.database.sensor_buckets.create_index([("device_id", 1), ("hour", 1)])
+                await cls.database.sensor_buckets.create_index("hour")
+                await cls.database.sensor_buckets.create_index(
+                    [("device_id", 1), ("hour", 1)], name="open_bucket", unique=True, partialFilterExpression={"open": True}
+                )
+            except Exception as index_error:
+                logger.warning(f"Could not create indexes on 'sensor_buckets': {str(index_error)}")
                 
         except Exception as e:
             logger.error(f"Failed to verify MongoDB connection: {str(e)}")
+            # Let the next ensure_connected() try again instead of using an unverified client
+            cls.database = None
             raise
 
     @classmethod
@@ -173,52 +247,250 @@ class MongoDB:
                 await cls.connect()
 
     @classmethod
-    async def insert_sensor_data(cls, data: SensorDataInput) -> str:
-        """Insert sensor data into MongoDB"""
+    async def _run(cls, operation: Callable[..., Awaitable[T]]) -> T:
+        """Run `operation(database)`, reconnecting and retrying once if the
+        event loop was closed underneath the client (serverless cold paths)"""
         await cls.ensure_connected()
-        
-        document = {
-            "timestamp": datetime.utcnow(),
-            "temperature": data.temperature,
-            "humidity": data.humidity,
-            "voc": data.voc,
-            "light": data.light,
-            "sound": data.sound,
-            "accelerometer": {
-                "x": data.accelerometer.x,
-                "y": data.accelerometer.y,
-                "z": data.accelerometer.z,
-            },
-            "gyroscope": {
-                "x": data.gyroscope.x,
-                "y": data.gyroscope.y,
-                "z": data.gyroscope.z,
-            },
-        }
-        
         try:
-            result = await cls.database.sensor_readings.insert_one(document)
-            return str(result.inserted_id)
+            return await operation(cls.database)
         except RuntimeError as e:
-            # Catch "Event loop is closed" errors and retry with fresh connection
             if "Event loop is closed" in str(e) or "loop is closed" in str(e).lower():
                 logger.warning("Event loop closed during operation, reconnecting and retrying...")
                 cls.client = None
                 cls.database = None
                 cls._client_loop_id = None
                 await cls.ensure_connected()
-                result = await cls.database.sensor_readings.insert_one(document)
-                return str(result.inserted_id)
+                return await operation(cls.database)
             raise
 
+    @staticmethod
+    def _device_filter(device_id: Optional[str]) -> dict:
+        """Query filter for one device's documents, or all devices if device_id is None.
+        Documents stored before device ids were recorded belong to the default device."""
+        if device_id is None:
+            return {}
+        if device_id == DEFAULT_DEVICE_ID:
+            return {"device_id": {"$in": [DEFAULT_DEVICE_ID, None]}}
+        return {"device_id": device_id}
+
+    @staticmethod
+    def build_sensor_document(data: SensorDataInput, timestamp: datetime) -> dict:
+        """Build the sensor_readings document for a single reading.
+        The field set comes from the sensor registry (app/models/registry.py);
+        fields the board left out of a sparse record are not stored."""
+        return {"timestamp": timestamp, **data.model_dump(exclude=_METADATA_FIELDS, exclude_none=True)}
+
     @classmethod
-    async def get_all_sensor_data(cls) -> List[SensorDataOutput]:
-        """Get all sensor data from MongoDB"""
+    def _build_ingest_document(cls, data: SensorDataInput, device_id: Optional[str], timestamp: datetime, received_at: datetime) -> dict:
+        """Build a sensor_readings document with its ingest metadata"""
+        document = cls.build_sensor_document(data, timestamp)
+        document["received_at"] = received_at
+        if data.timestamp is not None:
+            document["device_timestamp"] = to_naive_utc(data.timestamp)
+        document["device_id"] = device_id or DEFAULT_DEVICE_ID
+        if data.sample_rates_hz:
+            document["sample_rates_hz"] = data.sample_rates_hz
+        if data.report_interval_s is not None:
+            document["report_interval_s"] = data.report_interval_s
+        if data.seq is not None:
+            document["seq"] = data.seq
+        return document
+
+    @classmethod
+    def build_live_document(cls, data: SensorDataInput, received_at: Optional[datetime] = None) -> dict:
+        """Build the document for a reading uploaded as it was taken, stamping it
+        with server time and feeding its device timestamp to the clock estimate"""
+        received_at = received_at or datetime.utcnow()
+        timestamp = ClockSync.stamp(data.device_id, data.timestamp, received_at)
+        return cls._build_ingest_document(data, data.device_id, timestamp, received_at)
+
+    @staticmethod
+    def _forward_fill(documents: List[dict]) -> List[dict]:
+        """Fill fields missing from sparse readings with the last value reported
+        by the same device. Expects documents sorted newest first, as returned by
+        the read queries."""
+        last_values_by_device = {}
+        for doc in reversed(documents):
+            last_values = last_values_by_device.setdefault(doc.get("device_id", DEFAULT_DEVICE_ID), {})
+            for name in SENSOR_FIELD_NAMES:
+                if doc.get(name) is not None:
+                    last_values[name] = doc[name]
+                elif name in last_values:
+                    doc[name] = last_values[name]
+        return documents
+
+    @classmethod
+    async def insert_sensor_data(cls, data: SensorDataInput) -> Optional[str]:
+        """Insert sensor data into MongoDB, or into the write-ahead log if it is
+        enabled and MongoDB is unavailable.
+        Returns None if a reading with the same seq is already stored (a retried upload)."""
+        if data.seq is not None and SequenceWindows.seen(data.device_id, data.seq):
+            return None
+        
+        ids = await cls.write_sensor_documents([cls.build_live_document(data)])
+        return ids[0]
+
+    @classmethod
+    async def insert_sensor_data_batch(cls, readings: List[TimestampedSensorDataInput], device_id: Optional[str] = None) -> int:
+        """Insert buffered readings in one round trip, keeping their device-side timestamps.
+        Returns the number of readings stored; readings whose seq is already stored are skipped."""
+        received_at = datetime.utcnow()
+        # A request always comes from a single board
+        device_id = device_id or readings[0].device_id
+        timestamps = ClockSync.correct_buffered(device_id, [reading.timestamp for reading in readings])
+        documents = [
+            cls._build_ingest_document(reading, device_id, timestamp, received_at)
+            for reading, timestamp in zip(readings, timestamps)
+        ]
+        return await cls.insert_sensor_documents(documents)
+
+    @classmethod
+    async def insert_sensor_documents(cls, documents: List[dict]) -> int:
+        """Store prepared reading documents, see write_sensor_documents.
+        Returns the number stored, excluding duplicates of already stored seqs."""
+        ids = await cls.write_sensor_documents(documents)
+        return sum(1 for record_id in ids if record_id is not None)
+
+    @classmethod
+    async def write_sensor_documents(cls, documents: List[dict]) -> List[Optional[str]]:
+        """Store prepared reading documents in the configured storage layout, or in
+        the write-ahead log if it is enabled and MongoDB is unavailable.
+        Returns the id of each document, or None for a duplicate of an already stored seq."""
+        ids: List[Optional[str]] = [None] * len(documents)
+        # Drop readings known to be stored, and seqs repeated within the request
+        fresh = []
+        fresh_indexes = []
+        seqs = set()
+        for index, document in enumerate(documents):
+            seq = document.get("seq")
+            if seq is not None:
+                key = (document.get("device_id"), seq)
+                if key in seqs or SequenceWindows.seen(key[0], seq):
+                    continue
+                seqs.add(key)
+            fresh.append(document)
+            fresh_indexes.append(index)
+        if not fresh:
+            return ids
+        
+        # Final ids up front: replaying a reading MongoDB did store is rejected by its _id
+        IngestLog.assign_ids(fresh)
+        try:
+            if IngestLog.writes_ahead():
+                await IngestLog.append(fresh)
+                fresh_ids = [str(document["_id"]) for document in fresh]
+            else:
+                fresh_ids = await cls.store_sensor_documents(fresh)
+        except PyMongoError as e:
+            if not IngestLog.enabled():
+                raise
+            IngestLog.record_store_failure(e)
+            logger.warning(f"MongoDB write failed, logging {len(fresh)} readings for replay: {str(e)}")
+            # Readings written before the failure are rejected on replay by their _id
+            await IngestLog.append(fresh)
+            fresh_ids = [str(document["_id"]) for document in fresh]
+        # Every seq is now stored, by this request or an earlier one
+        for device_id, seq in seqs:
+            SequenceWindows.mark(device_id, [seq])
+        for index, record_id in zip(fresh_indexes, fresh_ids):
+            ids[index] = record_id
+        return ids
+
+    @classmethod
+    async def store_sensor_documents(cls, documents: List[dict]) -> List[Optional[str]]:
+        """Write reading documents straight to MongoDB, bypassing the sequence
+        windows and the write-ahead log. Used by the log replayer.
+        Returns the id of each document, or None if its seq is already stored."""
+        await cls.ensure_connected()
+        if cls.storage_layout == STORAGE_LAYOUT_BUCKETS:
+            return await cls._insert_bucket_documents(documents)
+        return await cls._insert_reading_documents(documents)
+
+    @staticmethod
+    def _only_duplicates(error: BulkWriteError) -> bool:
+        return all(write_error["code"] == DUPLICATE_KEY_ERROR for write_error in error.details["writeErrors"])
+
+    @classmethod
+    async def _insert_reading_documents(cls, documents: List[dict]) -> List[Optional[str]]:
+        """Insert one document per reading; duplicates of stored seqs are rejected by the unique index"""
+        rejected = set()
+        try:
+            # insert_many sets _id on every document before sending it
+            await cls._run(lambda db: db.sensor_readings.insert_many(documents, ordered=False))
+        except BulkWriteError as e:
+            if not cls._only_duplicates(e):
+                raise
+            rejected = {write_error["index"] for write_error in e.details["writeErrors"]}
+        return [None if index in rejected else str(document["_id"]) for index, document in enumerate(documents)]
+
+    @classmethod
+    async def _insert_bucket_documents(cls, documents: List[dict]) -> List[Optional[str]]:
+        """Append readings to their buckets with one upsert per bucket, run concurrently"""
+        IngestLog.assign_ids(documents)
+        groups = group_by_bucket(documents)
+        results = await asyncio.gather(*(cls._insert_bucket_group(device_id, hour, group) for device_id, hour, group in groups))
+        ids_by_document = {
+            id(document): record_id
+            for (_, _, group), group_ids in zip(groups, results)
+            for document, record_id in zip(group, group_ids)
+        }
+        return [ids_by_document[id(document)] for document in documents]
+
+    @staticmethod
+    def _is_stored_reading(error: DuplicateKeyError) -> bool:
+        """True if the error comes from the index on stored ids or seqs, rather
+        than from the one allowing a single open bucket"""
+        key_pattern = (error.details or {}).get("keyPattern", {})
+        if key_pattern:
+            return "seqs" in key_pattern or "samples._id" in key_pattern
+        return "open_bucket" not in str(error)
+
+    @classmethod
+    async def _insert_bucket_group(cls, device_id: str, hour: datetime, group: List[dict]) -> List[Optional[str]]:
+        """Append a group of readings to one bucket"""
+        ids = [document["_id"] for document in group]
+        seqs = document_seqs(group)
+        while True:
+            try:
+                await cls._run(lambda db: db.sensor_buckets.update_one(
+                    bucket_filter(device_id, hour, len(group), ids, seqs),
+                    bucket_update(group),
+                    upsert=True,
+                ))
+                return [str(record_id) for record_id in ids]
+            except DuplicateKeyError as e:
+                if not cls._is_stored_reading(e):
+                    # Another bucket is open for the hour. Close it if it is full, and retry
+                    closed = await cls._run(lambda db: db.sensor_buckets.update_one(
+                        full_bucket_filter(device_id, hour, len(group)), {"$set": {"open": False}}
+                    ))
+                    if closed.modified_count or not await cls._run(lambda db: db.sensor_buckets.find_one(
+                        {
+                            "device_id": device_id, "hour": hour, "open": True,
+                            "$or": [{"samples._id": {"$in": ids}}, {"seqs": {"$in": seqs}}],
+                        },
+                        projection={"_id": True},
+                    )):
+                        # Closed, or a concurrent writer just opened it: the next attempt fits
+                        continue
+                    # The open bucket has room, so it was skipped for holding one of the readings
+                if len(group) == 1:
+                    return [None]
+                # A group containing an already stored reading is rejected as a whole;
+                # retry it one reading at a time to keep the new readings
+                return [(await cls._insert_bucket_group(device_id, hour, [document]))[0] for document in group]
+
+    @classmethod
+    async def get_all_sensor_data(cls, device_id: Optional[str] = None) -> List[SensorDataOutput]:
+        """Get all sensor data from MongoDB, optionally for a single device"""
         await cls.ensure_connected()
+        query = cls._device_filter(device_id)
         
         try:
-            cursor = cls.database.sensor_readings.find().sort("timestamp", -1)
-            documents = await cursor.to_list(length=None)
+            cursor = cls.database.sensor_readings.find(query).sort("timestamp", -1)
+            documents = await cursor.to_list(length=None) + await cls._get_bucket_readings(query)
+            documents.sort(key=lambda doc: doc["timestamp"], reverse=True)
+            documents = cls._forward_fill(documents)
             
             results = []
             for doc in documents:
@@ -241,8 +513,10 @@ class MongoDB:
                 cls.database = None
                 cls._client_loop_id = None
                 await cls.ensure_connected()
-                cursor = cls.database.sensor_readings.find().sort("timestamp", -1)
-                documents = await cursor.to_list(length=None)
+                cursor = cls.database.sensor_readings.find(query).sort("timestamp", -1)
+                documents = await cursor.to_list(length=None) + await cls._get_bucket_readings(query)
+                documents.sort(key=lambda doc: doc["timestamp"], reverse=True)
+                documents = cls._forward_fill(documents)
                 
                 results = []
                 for doc in documents:
@@ -256,12 +530,187 @@ class MongoDB:
             logger.error(f"Error in get_all_sensor_data: {str(e)}", exc_info=True)
             raise
 
+    @classmethod
+    async def insert_telemetry(cls, data: TelemetryInput) -> str:
+        """Insert a runtime telemetry record into MongoDB"""
+        await cls.ensure_connected()
+        
+        document = {"timestamp": datetime.utcnow(), **data.model_dump()}
+        document["device_id"] = data.device_id or DEFAULT_DEVICE_ID
+        
+        try:
+            result = await cls.database.device_telemetry.insert_one(document)
+            return str(result.inserted_id)
+        except RuntimeError as e:
+            # Catch "Event loop is closed" errors and retry with fresh connection
+            if "Event loop is closed" in str(e) or "loop is closed" in str(e).lower():
+                logger.warning("Event loop closed during operation, reconnecting and retrying...")
+                cls.client = None
+                cls.database = None
+                cls._client_loop_id = None
+                await cls.ensure_connected()
+                result = await cls.database.device_telemetry.insert_one(document)
+                return str(result.inserted_id)
+            raise
+
+    @classmethod
+    async def get_telemetry(cls, limit: int, device_id: Optional[str] = None) -> List[TelemetryOutput]:
+        """Get the most recent telemetry records from MongoDB, optionally for a single device"""
+        await cls.ensure_connected()
+        query = cls._device_filter(device_id)
+        
+        try:
+            cursor = cls.database.device_telemetry.find(query).sort("timestamp", -1).limit(limit)
+            documents = await cursor.to_list(length=None)
+        except RuntimeError as e:
+            # Catch "Event loop is closed" errors and retry with fresh connection
+            if "Event loop is closed" in str(e) or "loop is closed" in str(e).lower():
+                logger.warning("Event loop closed during operation, reconnecting and retrying...")
+                cls.client = None
+                cls.database = None
+                cls._client_loop_id = None
+                await cls.ensure_connected()
+                cursor = cls.database.device_telemetry.find(query).sort("timestamp", -1).limit(limit)
+                documents = await cursor.to_list(length=None)
+            else:
+                raise
+        
+        results = []
+        for doc in documents:
+            doc["_id"] = str(doc["_id"])
+            results.append(TelemetryOutput(**doc))
+        return results
+
+    @classmethod
+    async def insert_imu_event(cls, event: ImuEventInput) -> str:
+        """Insert an IMU event with its raw capture into MongoDB"""
+        received_at = datetime.utcnow()
+        document = event.model_dump(exclude={"timestamp"}, exclude_none=True)
+        # Events are uploaded as soon as they are detected, so they count as live observations
+        document["timestamp"] = ClockSync.stamp(event.device_id, event.timestamp, received_at)
+        document["received_at"] = received_at
+        if event.timestamp is not None:
+            document["device_timestamp"] = to_naive_utc(event.timestamp)
+        document["device_id"] = event.device_id or DEFAULT_DEVICE_ID
+        
+        result = await cls._run(lambda db: db.imu_events.insert_one(document))
+        return str(result.inserted_id)
+
+    @classmethod
+    async def get_imu_events(cls, event_type: Optional[str], limit: int, include_capture: bool, device_id: Optional[str] = None) -> List[ImuEventOutput]:
+        """Get the most recent IMU events, optionally filtered by type and device"""
+        query = cls._device_filter(device_id)
+        if event_type:
+            query["event_type"] = event_type
+        projection = None if include_capture else {"capture": False}
+        documents = await cls._run(
+            lambda db: db.imu_events.find(query, projection).sort("timestamp", -1).limit(limit).to_list(length=None)
+        )
+        
+        results = []
+        for doc in documents:
+            doc["_id"] = str(doc["_id"])
+            results.append(ImuEventOutput(**doc))
+        return results
+
+    @classmethod
+    async def get_device_config(cls, device_id: str) -> Optional[dict]:
+        """Get the stored config document for a device"""
+        return await cls._run(lambda db: db.device_configs.find_one({"_id": device_id}))
+
+    @classmethod
+    async def update_device_config(cls, device_id: str, values: dict) -> dict:
+        """Apply a partial config update and bump the version if anything changed.
+        `changed_in` records the version each setting last changed in, so ingest
+        responses can send a board only what changed since the version it runs.
+        Raises ValueError if a concurrent update won the race."""
+        current = await cls.get_device_config(device_id)
+        if current is None:
+            current = {"_id": device_id, "version": 0, "values": {}, "changed_in": {}}
+        
+        changed = {key: value for key, value in values.items() if key not in current["values"] or current["values"][key] != value}
+        if not changed:
+            return current
+        
+        version = current["version"] + 1
+        update = {"$set": {"version": version, "updated_at": datetime.utcnow()}}
+        for key, value in changed.items():
+            update["$set"][f"values.{key}"] = value
+            update["$set"][f"changed_in.{key}"] = version
+        
+        try:
+            document = await cls._run(lambda db: db.device_configs.find_one_and_update(
+                {"_id": device_id, "version": current["version"]},
+                update,
+                upsert=current["version"] == 0,
+                return_document=ReturnDocument.AFTER,
+            ))
+        except DuplicateKeyError:
+            # A concurrent request created the config first; the upsert collided on _id
+            document = None
+        if document is None:
+            raise ValueError(f"Config for device '{device_id}' was modified concurrently")
+        return document
+
+    @classmethod
+    async def get_sensor_data_range(cls, start: datetime, end: datetime, device_id: Optional[str] = None) -> List[dict]:
+        """Get raw, forward-filled reading documents in [start, end), oldest first,
+        optionally for a single device"""
+        device_filter = cls._device_filter(device_id)
+        # Start from the last reading before the window so sparse fields have a value to carry in
+        before = await cls._run(
+            lambda db: db.sensor_readings.find({**device_filter, "timestamp": {"$lt": start}}).sort("timestamp", -1).limit(1).to_list(length=None)
+        )
+        documents = await cls._run(
+            lambda db: db.sensor_readings.find({**device_filter, "timestamp": {"$gte": start, "$lt": end}}).sort("timestamp", -1).to_list(length=None)
+        )
+        # Buckets of the hour before the window also seed the forward fill
+        for reading in await cls._get_bucket_readings(device_filter, bucket_hour(start) - BUCKET_SPAN, end):
+            if reading["timestamp"] < start:
+                before.append(reading)
+            elif reading["timestamp"] < end:
+                documents.append(reading)
+        documents.sort(key=lambda doc: doc["timestamp"], reverse=True)
+        before.sort(key=lambda doc: doc["timestamp"], reverse=True)
+        documents = cls._forward_fill(documents + before)[:len(documents)]
+        documents.reverse()
+        return documents
+
+    @classmethod
+    async def _get_bucket_readings(cls, device_filter: dict, start: Optional[datetime] = None, end: Optional[datetime] = None) -> List[dict]:
+        """Unpacked readings of the buckets whose hour falls in [start, end)"""
+        query = dict(device_filter)
+        if start is not None:
+            query["hour"] = {"$gte": start, "$lt": end}
+        buckets = await cls._run(lambda db: db.sensor_buckets.find(query).to_list(length=None))
+        return [reading for bucket in buckets for reading in unpack_bucket(bucket)]
+
+    @classmethod
+    async def touch_device(cls, device_id: str, seen_at: datetime):
+        """Register a device on first contact and record when it was last seen"""
+        await cls._run(lambda db: db.devices.update_one(
+            {"_id": device_id},
+            {"$set": {"last_seen": seen_at}, "$setOnInsert": {"first_seen": seen_at}},
+            upsert=True,
+        ))
+
+    @classmethod
+    async def get_devices(cls) -> List[dict]:
+        """Get every registered device, most recently seen first"""
+        return await cls._run(lambda db: db.devices.find().sort("last_seen", -1).to_list(length=None))
+
+    @classmethod
+    async def get_device(cls, device_id: str) -> Optional[dict]:
+        """Get a registered device"""
+        return await cls._run(lambda db: db.devices.find_one({"_id": device_id}))
+
     @classmethod
     async def clear_all_data(cls) -> int:
         """Clear all sensor data (for testing)"""
         await cls.ensure_connected()
         
         try:
+            await cls.database.sensor_buckets.delete_many({})
             result = await cls.database.sensor_readings.delete_many({})
             return result.deleted_count
         except RuntimeError as e:
@@ -272,6 +721,7 @@ class MongoDB:
                 cls.database = None
                 cls._client_loop_id = None
                 await cls.ensure_connected()
+                await cls.database.sensor_buckets.delete_many({})
                 result = await cls.database.sensor_readings.delete_many({})
                 return result.deleted_count
             raise
@@ -1,17 +1,26 @@
 import os
+import asyncio
 import logging
 from contextlib import asynccontextmanager
-from fastapi import FastAPI
+from fastapi import FastAPI, Request
 from fastapi.middleware.cors import CORSMiddleware
+from fastapi.responses import JSONResponse
 from dotenv import load_dotenv
+from pymongo.errors import PyMongoError
 from app.database.mongodb import MongoDB
-from app.routes import sensors, test_data
+from app.routes import devices, events, ingest, sensors, telemetry, test_data
+from app.services.admission import AdmissionRejected
+from app.services.mqtt_bridge import MqttBridge
+from app.services.pipeline import Pipeline
+from app.services.udp_ingest import UdpIngest
+from app.services.wal import IngestLog
 
 # Configure logging
 logging.basicConfig(
     level=logging.INFO,
     format='%(asctime)s - %(name)s - %(levelname)s - %(message)s'
 )
+logger = logging.getLogger(__name__)
 
 # Load environment variables
 load_dotenv()
@@ -21,9 +30,30 @@ load_dotenv()
 async def lifespan(app: FastAPI):
     """Lifespan context manager for startup and shutdown"""
     # Startup
-    await MongoDB.connect()
+    replayer = None
+    if IngestLog.enabled():
+        # Readings can be accepted into the log while MongoDB is down, so start without it
+        try:
+            await MongoDB.connect()
+        except PyMongoError as e:
+            logger.warning(f"MongoDB unavailable at startup, ingest goes to the write-ahead log: {str(e)}")
+        replayer = asyncio.create_task(IngestLog.run_replayer(MongoDB.store_sensor_documents))
+    else:
+        await MongoDB.connect()
+    if UdpIngest.enabled():
+        await UdpIngest.start()
+    if MqttBridge.enabled():
+        await MqttBridge.start()
     yield
     # Shutdown
+    if MqttBridge.enabled():
+        await MqttBridge.stop()
+    if UdpIngest.enabled():
+        await UdpIngest.stop()
+    await Pipeline.drain()
+    if replayer is not None:
+        replayer.cancel()
+        await IngestLog.close()
     await MongoDB.disconnect()
 
 
@@ -47,8 +77,23 @@ app.add_middleware(
     max_age=3600,  # Cache preflight requests for 1 hour
 )
 
+
+@app.exception_handler(AdmissionRejected)
+async def admission_rejected_handler(request: Request, exc: AdmissionRejected):
+    """Overloaded or rate limited ingest: tell the board when to retry"""
+    return JSONResponse(
+        status_code=429,
+        content={"detail": exc.reason},
+        headers={"Retry-After": str(exc.retry_after_s)},
+    )
+
+
 # Include routers
 app.include_router(sensors.router)
+app.include_router(telemetry.router)
+app.include_router(events.router)
+app.include_router(devices.router)
+app.include_router(ingest.router)
 app.include_router(test_data.router)
 
 
@@ -59,7 +104,20 @@ async def root():
         "version": "1.0.0",
         "endpoints": {
             "POST /api/send_data": "Receive sensor data from embedded system",
+            "POST /api/send_data_batch": "Receive buffered sensor data with device timestamps",
             "GET /api/sensors_data": "Get all sensor data",
+            "GET /api/sensors_summary": "Get time-weighted sensor aggregates",
+            "GET /api/orientation": "Get device orientation and tilt alarms",
+            "GET /api/clock_sync": "Get per-device clock offset/drift estimates",
+            "POST /api/send_telemetry": "Receive runtime telemetry from embedded system",
+            "GET /api/telemetry": "Get recent runtime telemetry",
+            "POST /api/send_event": "Receive an IMU event with its raw capture",
+            "GET /api/events": "Get recent IMU events",
+            "GET /api/devices": "List registered devices",
+            "GET /api/devices/{device_id}": "Get when a device was first and last seen",
+            "GET /api/devices/{device_id}/config": "Get a device's runtime config",
+            "PUT /api/devices/{device_id}/config": "Update a device's runtime config",
+            "GET /api/ingest_status": "Get ingest pipeline stage timings, admission counters, write-ahead log, UDP listener and MQTT bridge state",
             "GET /api/database_info": "Get database and collection information",
             "POST /api/generate_random_data": "Generate a single random sensor reading",
             "POST /api/seed_test_data": "Generate test data (for development)"
@@ -0,0 +1,9 @@
+from pydantic import BaseModel, Field
+from datetime import datetime
+
+
+class DeviceOutput(BaseModel):
+    """Entry of the device registry"""
+    device_id: str
+    first_seen: datetime
+    last_seen: datetime = Field(..., description="Last upload, accurate to the registry's touch interval")
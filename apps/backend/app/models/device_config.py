@@ -0,0 +1,32 @@
+from pydantic import BaseModel, Field, NonNegativeFloat, PositiveFloat, PositiveInt, field_validator
+from typing import Annotated, Dict, Optional, Tuple
+from datetime import datetime
+from app.models.sensor import SensorFieldKeys
+
+
+class DeviceConfigValues(BaseModel):
+    """Runtime settings the board applies without reflashing.
+    Omitted fields keep their current value on update."""
+    sample_periods_ms: Optional[Annotated[Dict[str, PositiveInt], SensorFieldKeys]] = Field(None, description="Sampling period per sensor field in milliseconds")
+    upload_interval_s: Optional[int] = Field(None, ge=1, le=86400, description="Seconds between uploads")
+    deadbands: Optional[Annotated[Dict[str, NonNegativeFloat], SensorFieldKeys]] = Field(None, description="Minimum change per sensor field before it is reported")
+    max_report_interval_s: Optional[int] = Field(None, ge=1, le=86400, description="Heartbeat: report every field at least this often")
+    batch_size: Optional[int] = Field(None, ge=1, le=500, description="Readings per batch upload")
+    sample_rate_bounds_hz: Optional[Annotated[Dict[str, Tuple[PositiveFloat, PositiveFloat]], SensorFieldKeys]] = Field(
+        None, description="[min, max] sample rate per sensor field for the adaptive sampling controller"
+    )
+
+    @field_validator("sample_rate_bounds_hz")
+    @classmethod
+    def _check_rate_bounds(cls, value: Optional[Dict[str, Tuple[float, float]]]):
+        for name, (low, high) in (value or {}).items():
+            if low > high:
+                raise ValueError(f"Minimum rate for '{name}' exceeds its maximum")
+        return value
+
+
+class DeviceConfigOutput(BaseModel):
+    device_id: str
+    version: int
+    values: DeviceConfigValues
+    updated_at: Optional[datetime] = None
@@ -0,0 +1,41 @@
+from pydantic import BaseModel, Field, model_validator
+from typing import List, Literal, Optional, Tuple
+from datetime import datetime
+
+ImuEventType = Literal["shock", "free_fall", "vibration_onset"]
+
+# One raw IMU sample: accelerometer x, y, z (m/s²) then gyroscope x, y, z (rad/s)
+ImuSample = Tuple[float, float, float, float, float, float]
+
+
+class _ImuEventBase(BaseModel):
+    device_id: Optional[str] = Field(None, min_length=1, max_length=64, description="Identifier of the reporting board")
+    event_type: ImuEventType
+    peak_magnitude: float = Field(..., ge=0, description="Peak |a| for shock, minimum |a| for free fall, windowed RMS for vibration (m/s²)")
+    duration_ms: float = Field(..., ge=0, description="Time the detector stayed triggered, until hysteresis released it")
+    jerk_peak: Optional[float] = Field(None, ge=0, description="Peak jerk during the event (m/s³)")
+    sample_rate_hz: float = Field(..., gt=0, description="Sample rate of the capture")
+    trigger_index: int = Field(..., ge=0, description="Index of the trigger sample in capture; earlier samples are pre-trigger")
+
+
+class ImuEventInput(_ImuEventBase):
+    """Event detected on the full-rate IMU stream, with the raw samples around the trigger"""
+    timestamp: Optional[datetime] = Field(None, description="Device-side trigger time (UTC, ISO 8601 or Unix seconds)")
+    capture: List[ImuSample] = Field(..., min_length=1, max_length=2048, description="Raw samples around the trigger")
+
+    @model_validator(mode="after")
+    def _check_trigger_index(self):
+        if self.trigger_index >= len(self.capture):
+            raise ValueError("trigger_index must point inside capture")
+        return self
+
+
+class ImuEventOutput(_ImuEventBase):
+    """Output model with server-side timestamp; capture is empty unless requested"""
+    id: Optional[str] = Field(None, alias="_id")
+    timestamp: datetime
+    device_timestamp: Optional[datetime] = None
+    capture: List[ImuSample] = []
+
+    class Config:
+        populate_by_name = True
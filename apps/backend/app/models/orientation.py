@@ -0,0 +1,24 @@
+from pydantic import BaseModel, Field
+from typing import List, Literal, Optional
+from datetime import datetime
+from app.models.sensor import Quaternion
+
+
+class OrientationPoint(BaseModel):
+    device_id: Optional[str] = None
+    timestamp: datetime
+    quaternion: Quaternion
+    roll_deg: float
+    pitch_deg: float
+    yaw_deg: float
+    tilt_deg: float = Field(..., description="Angle between the device z axis and vertical")
+    source: Literal["device", "server"] = Field(..., description="Fused on the device, or recomputed from stored IMU readings")
+    tilt_alarm: bool
+
+
+class OrientationOutput(BaseModel):
+    start: datetime
+    end: datetime
+    tilt_threshold_deg: float
+    alarms: int = Field(..., description="Number of points whose tilt exceeds the threshold")
+    points: List[OrientationPoint]
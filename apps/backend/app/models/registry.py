@@ -0,0 +1,44 @@
+"""
+Single source of truth for the sensor fields reported by the embedded system.
+
+The Pydantic ingest/output models, the MongoDB document layout and the
+frontend types (generated by scripts/generate_sensor_types.py) are all derived
+from SENSOR_FIELDS, so adding a sensor is one entry below. The UDP ingest
+frame (app/services/udp_ingest.py) identifies fields by their position here,
+so new fields go at the end.
+"""
+from dataclasses import dataclass
+from typing import Optional
+
+SCALAR_FLOAT = "float"
+SCALAR_INT = "int"
+VECTOR3 = "vector3"
+SOUND_SPECTRUM = "sound_spectrum"
+QUATERNION = "quaternion"
+
+# Octave band centre frequencies of SOUND_SPECTRUM band levels
+OCTAVE_BAND_CENTERS_HZ = (63, 125, 250, 500, 1000, 2000, 4000, 8000)
+
+
+@dataclass(frozen=True)
+class SensorField:
+    name: str
+    kind: str
+    description: str
+    ge: Optional[float] = None
+    le: Optional[float] = None
+
+
+SENSOR_FIELDS = (
+    SensorField("temperature", SCALAR_FLOAT, "Temperature in Celsius"),
+    SensorField("humidity", SCALAR_FLOAT, "Humidity percentage"),
+    SensorField("voc", SCALAR_INT, "VOC index (uint32)", ge=0),
+    SensorField("light", SCALAR_INT, "Light sensor value (0-4095)", ge=0, le=4095),
+    SensorField("sound", SCALAR_INT, "Sound sensor value (0-4095)", ge=0, le=4095),
+    SensorField("accelerometer", VECTOR3, "Acceleration in m/s²"),
+    SensorField("gyroscope", VECTOR3, "Angular velocity in rad/s"),
+    SensorField("sound_spectrum", SOUND_SPECTRUM, "Acoustic features computed on the device from the sound ADC stream"),
+    SensorField("orientation", QUATERNION, "Orientation quaternion fused on the device from accelerometer and gyroscope"),
+)
+
+SENSOR_FIELD_NAMES = frozenset(field.name for field in SENSOR_FIELDS)
@@ -1,43 +1,149 @@
-from pydantic import BaseModel, Field
-from typing import Optional
+from pydantic import AfterValidator, BaseModel, Field, PositiveFloat, create_model, model_validator
+from typing import Annotated, Dict, List, Optional
 from datetime import datetime
+from app.models.registry import (
+    SENSOR_FIELDS, SENSOR_FIELD_NAMES, SCALAR_FLOAT, SCALAR_INT, VECTOR3, SOUND_SPECTRUM, QUATERNION,
+    OCTAVE_BAND_CENTERS_HZ,
+)
 
+# Used for per-device state when a board does not send a device_id
+DEFAULT_DEVICE_ID = "default"
 
-class Accelerometer(BaseModel):
+
+def _check_sensor_field_names(value: dict) -> dict:
+    unknown = set(value) - SENSOR_FIELD_NAMES
+    if unknown:
+        raise ValueError(f"Unknown sensor fields: {', '.join(sorted(unknown))}")
+    return value
+
+
+# Validator for dicts keyed by sensor field name, e.g. Annotated[Dict[str, float], SensorFieldKeys]
+SensorFieldKeys = AfterValidator(_check_sensor_field_names)
+
+
+class Vector3(BaseModel):
     x: float
     y: float
     z: float
 
 
-class Gyroscope(BaseModel):
+class SoundSpectrum(BaseModel):
+    """Compact acoustic features for one report window"""
+    band_levels_db: List[float] = Field(
+        ...,
+        min_length=len(OCTAVE_BAND_CENTERS_HZ),
+        max_length=len(OCTAVE_BAND_CENTERS_HZ),
+        description="Energy per octave band in dB, bands centred at OCTAVE_BAND_CENTERS_HZ",
+    )
+    laeq_db: float = Field(..., description="A-weighted equivalent level, dB(A)")
+    peak_db: float = Field(..., description="Highest short-term level in the window, dB")
+    peak_events: int = Field(..., ge=0, description="Number of peaks above the device's event threshold")
+
+
+class Quaternion(BaseModel):
+    """Unit quaternion rotating the device frame into the earth frame"""
+    w: float
     x: float
     y: float
     z: float
 
+    @model_validator(mode="after")
+    def _check_norm(self):
+        if self.w * self.w + self.x * self.x + self.y * self.y + self.z * self.z == 0:
+            raise ValueError("Quaternion must be non-zero")
+        return self
+
+
+_FIELD_TYPES = {
+    SCALAR_FLOAT: float,
+    SCALAR_INT: int,
+    VECTOR3: Vector3,
+    SOUND_SPECTRUM: SoundSpectrum,
+    QUATERNION: Quaternion,
+}
+
+
+def _sensor_field_definitions(with_constraints: bool) -> dict:
+    """Pydantic field definitions for every registered sensor.
+    Every field is optional: the board omits fields that stayed within their
+    deadband since the last upload."""
+    definitions = {}
+    for field in SENSOR_FIELDS:
+        if with_constraints:
+            info = Field(None, ge=field.ge, le=field.le, description=field.description)
+        else:
+            info = Field(None, description=field.description)
+        definitions[field.name] = (Optional[_FIELD_TYPES[field.kind]], info)
+    return definitions
+
 
-class SensorDataInput(BaseModel):
-    """Input model matching embedded system JSON format exactly"""
-    temperature: float = Field(..., description="Temperature in Celsius")
-    humidity: float = Field(..., description="Humidity percentage")
-    voc: int = Field(..., ge=0, description="VOC index (uint32)")
-    light: int = Field(..., ge=0, le=4095, description="Light sensor value (0-4095)")
-    sound: int = Field(..., ge=0, le=4095, description="Sound sensor value (0-4095)")
-    accelerometer: Accelerometer
-    gyroscope: Gyroscope
+class _SensorDataInputBase(BaseModel):
+    device_id: Optional[str] = Field(None, min_length=1, max_length=64, description="Identifier of the reporting board")
+    timestamp: Optional[datetime] = Field(None, description="Device-side sample time from the SNTP-synced clock (UTC, ISO 8601 or Unix seconds)")
+    config_version: Optional[int] = Field(None, ge=0, description="Version of the device config the board is running")
+    sample_rates_hz: Optional[Annotated[Dict[str, PositiveFloat], SensorFieldKeys]] = Field(None, description="Effective sample rate per sensor field chosen by the adaptive controller")
+    report_interval_s: Optional[PositiveFloat] = Field(None, description="Time span this reading summarises, i.e. the effective upload interval")
+    seq: Optional[int] = Field(None, ge=0, le=2**63 - 1, description="Per-device sequence number, increasing over the device's lifetime; readings with a stored seq are ignored")
 
+    @model_validator(mode="after")
+    def _require_sensor_value(self):
+        if all(getattr(self, name) is None for name in SENSOR_FIELD_NAMES):
+            raise ValueError("At least one sensor field must be present")
+        return self
 
-class SensorDataOutput(BaseModel):
-    """Output model with timestamp"""
+
+SensorDataInput = create_model(
+    "SensorDataInput",
+    __base__=_SensorDataInputBase,
+    __doc__="Input model matching embedded system JSON format; unchanged fields may be omitted",
+    **_sensor_field_definitions(with_constraints=True),
+)
+
+
+class TimestampedSensorDataInput(SensorDataInput):
+    """Reading replayed from the device's store-and-forward log"""
+    timestamp: datetime = Field(..., description="Device-side sample time (UTC, ISO 8601 or Unix seconds)")
+
+
+class SensorDataBatchInput(BaseModel):
+    """Bulk upload of buffered readings, oldest first"""
+    device_id: Optional[str] = Field(None, min_length=1, max_length=64, description="Identifier of the reporting board; per-reading device_ids must match it")
+    config_version: Optional[int] = Field(None, ge=0, description="Version of the device config the board is running")
+    readings: List[TimestampedSensorDataInput] = Field(..., min_length=1, max_length=500)
+
+
+class _SensorDataOutputBase(BaseModel):
     id: Optional[str] = Field(None, alias="_id")
+    device_id: Optional[str] = None
     timestamp: datetime
-    temperature: float
-    humidity: float
-    voc: int
-    light: int
-    sound: int
-    accelerometer: Accelerometer
-    gyroscope: Gyroscope
+    device_timestamp: Optional[datetime] = None
+    sample_rates_hz: Optional[Dict[str, float]] = None
+    report_interval_s: Optional[float] = None
+    seq: Optional[int] = None
 
     class Config:
         populate_by_name = True
 
+
+SensorDataOutput = create_model(
+    "SensorDataOutput",
+    __base__=_SensorDataOutputBase,
+    __doc__="Output model with timestamp",
+    **_sensor_field_definitions(with_constraints=False),
+)
+
+
+class FieldSummary(BaseModel):
+    """Time-weighted aggregate of one scalar sensor value"""
+    mean: float
+    min: float
+    max: float
+    samples: float = Field(..., description="Estimated number of underlying device samples")
+    covered_s: float = Field(..., description="Total time span covered by the readings")
+
+
+class SensorDataSummary(BaseModel):
+    start: datetime
+    end: datetime
+    readings: int
+    fields: Dict[str, FieldSummary] = Field(..., description="Keyed by field name, vector axes as e.g. 'accelerometer.x'")
@@ -0,0 +1,47 @@
+from pydantic import BaseModel, Field
+from typing import List, Optional
+from datetime import datetime
+
+
+class TaskStats(BaseModel):
+    """Per-task FreeRTOS run-time statistics"""
+    name: str = Field(..., max_length=16, description="Task name (configMAX_TASK_NAME_LEN)")
+    cpu_percent: float = Field(..., ge=0, le=100, description="Share of run time since the previous record")
+    stack_high_water: int = Field(..., ge=0, description="Minimum free stack ever, in words")
+
+
+class MutexStats(BaseModel):
+    """Wait times collected by the trace hooks for one mutex"""
+    name: str
+    acquisitions: int = Field(..., ge=0)
+    total_wait_us: int = Field(..., ge=0)
+    max_wait_us: int = Field(..., ge=0)
+
+
+class UploadLatency(BaseModel):
+    """Breakdown of the most recent upload in milliseconds"""
+    dns_ms: float = Field(..., ge=0)
+    connect_ms: float = Field(..., ge=0)
+    tls_ms: float = Field(..., ge=0)
+    send_ms: float = Field(..., ge=0)
+    response_ms: float = Field(..., ge=0)
+
+
+class TelemetryInput(BaseModel):
+    """Periodic runtime telemetry record sent by the board"""
+    device_id: Optional[str] = Field(None, min_length=1, max_length=64, description="Identifier of the reporting board")
+    uptime_s: int = Field(..., ge=0, description="Seconds since boot")
+    heap_free: int = Field(..., ge=0, description="xPortGetFreeHeapSize() in bytes")
+    heap_min_free: int = Field(..., ge=0, description="xPortGetMinimumEverFreeHeapSize() in bytes")
+    tasks: List[TaskStats]
+    mutexes: List[MutexStats] = []
+    upload: Optional[UploadLatency] = None
+
+
+class TelemetryOutput(TelemetryInput):
+    """Output model with timestamp"""
+    id: Optional[str] = Field(None, alias="_id")
+    timestamp: datetime
+
+    class Config:
+        populate_by_name = True
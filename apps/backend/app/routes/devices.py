@@ -0,0 +1,107 @@
+import logging
+from fastapi import APIRouter, Header, HTTPException
+from app.models.device import DeviceOutput
+from app.models.device_config import DeviceConfigValues, DeviceConfigOutput
+from app.database.mongodb import MongoDB
+from app.services.device_config import DeviceConfigs
+from typing import Callable, List, Optional
+
+logger = logging.getLogger(__name__)
+router = APIRouter(prefix="/api/devices", tags=["devices"])
+
+
+def resolve_device_id(body_device_id: Optional[str], header_device_id: Optional[str]) -> Optional[str]:
+    """Device id of an ingest request, from the body or the X-Device-Id header.
+    Raises a 400 if both are present and disagree."""
+    if body_device_id and header_device_id and body_device_id != header_device_id:
+        raise HTTPException(
+            status_code=400,
+            detail=f"device_id '{body_device_id}' does not match X-Device-Id header '{header_device_id}'",
+        )
+    return body_device_id or header_device_id
+
+
+# Maps the device id given in a request body to the request's device id
+DeviceIdResolver = Callable[[Optional[str]], Optional[str]]
+
+
+def ingest_device_id(
+    x_device_id: Optional[str] = Header(None, min_length=1, max_length=64, description="Identifier of the reporting board, alternative to the body field"),
+) -> DeviceIdResolver:
+    """Dependency of the ingest routes, declaring the X-Device-Id header.
+    Returns a function resolving the request's device id from the body field,
+    see resolve_device_id()."""
+    return lambda body_device_id: resolve_device_id(body_device_id, x_device_id)
+
+
+def _device_output(document: dict) -> DeviceOutput:
+    return DeviceOutput(device_id=document["_id"], first_seen=document["first_seen"], last_seen=document["last_seen"])
+
+
+@router.get("", response_model=List[DeviceOutput])
+async def get_devices():
+    """
+    Get every device that has uploaded data, most recently seen first.
+    """
+    try:
+        return [_device_output(document) for document in await MongoDB.get_devices()]
+    except Exception as e:
+        logger.error(f"Error retrieving devices: {str(e)}", exc_info=True)
+        raise HTTPException(status_code=500, detail=f"Failed to retrieve devices: {str(e)}")
+
+
+@router.get("/{device_id}", response_model=DeviceOutput)
+async def get_device(device_id: str):
+    """
+    Get when a device was first and last seen.
+    """
+    try:
+        document = await MongoDB.get_device(device_id)
+    except Exception as e:
+        logger.error(f"Error retrieving device: {str(e)}", exc_info=True)
+        raise HTTPException(status_code=500, detail=f"Failed to retrieve device: {str(e)}")
+    if document is None:
+        raise HTTPException(status_code=404, detail=f"Unknown device '{device_id}'")
+    return _device_output(document)
+
+
+def _config_output(device_id: str, document: dict) -> DeviceConfigOutput:
+    return DeviceConfigOutput(
+        device_id=device_id,
+        version=document["version"],
+        values=DeviceConfigValues(**document["values"]),
+        updated_at=document.get("updated_at"),
+    )
+
+
+@router.get("/{device_id}/config", response_model=DeviceConfigOutput, response_model_exclude_none=True)
+async def get_device_config(device_id: str):
+    """
+    Get the runtime config (sampling periods, upload interval, deadbands,
+    batch size) for a device.
+    """
+    try:
+        document = await DeviceConfigs.get(device_id)
+    except Exception as e:
+        logger.error(f"Error retrieving device config: {str(e)}", exc_info=True)
+        raise HTTPException(status_code=500, detail=f"Failed to retrieve device config: {str(e)}")
+    if document is None:
+        raise HTTPException(status_code=404, detail=f"No config for device '{device_id}'")
+    return _config_output(device_id, document)
+
+
+@router.put("/{device_id}/config", response_model=DeviceConfigOutput, response_model_exclude_none=True)
+async def update_device_config(device_id: str, values: DeviceConfigValues):
+    """
+    Update a device's runtime config. Only the fields present in the body are
+    changed; the version is bumped if anything changed. The board picks up the
+    change from the response to its next upload.
+    """
+    try:
+        document = await DeviceConfigs.update(device_id, values.model_dump(mode="json", exclude_unset=True))
+    except ValueError as e:
+        raise HTTPException(status_code=409, detail=str(e))
+    except Exception as e:
+        logger.error(f"Error updating device config: {str(e)}", exc_info=True)
+        raise HTTPException(status_code=500, detail=f"Failed to update device config: {str(e)}")
+    return _config_output(device_id, document)
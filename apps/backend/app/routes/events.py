@@ -0,0 +1,52 @@
+import logging
+from fastapi import APIRouter, Depends, HTTPException, Query
+from app.models.events import ImuEventInput, ImuEventOutput, ImuEventType
+from app.database.mongodb import MongoDB
+from app.services.devices import DeviceRegistry
+from app.services.admission import Admission
+from app.routes.devices import DeviceIdResolver, ingest_device_id
+from typing import List, Optional
+
+logger = logging.getLogger(__name__)
+router = APIRouter(prefix="/api", tags=["events"])
+
+
+@router.post("/send_event", status_code=200)
+async def send_event(
+    event: ImuEventInput,
+    device_id_of: DeviceIdResolver = Depends(ingest_device_id),
+):
+    """
+    Receive an IMU event (shock, free fall, vibration onset) detected on the
+    embedded system, including its pre/post-trigger raw capture.
+    """
+    event.device_id = device_id_of(event.device_id)
+    async with Admission.admit(event.device_id):
+        try:
+            record_id = await MongoDB.insert_imu_event(event)
+        except Exception as e:
+            raise HTTPException(status_code=500, detail=f"Failed to store event: {str(e)}")
+    await DeviceRegistry.touch(event.device_id)
+    return {
+        "status": "success",
+        "message": "Event stored successfully",
+        "id": record_id
+    }
+
+
+@router.get("/events", response_model=List[ImuEventOutput])
+async def get_events(
+    event_type: Optional[ImuEventType] = Query(None, description="Only return events of this type"),
+    limit: int = Query(100, ge=1, le=1000, description="Maximum number of events to return"),
+    include_capture: bool = Query(False, description="Include the raw sample capture of each event"),
+    device_id: Optional[str] = Query(None, description="Only return data from this device"),
+):
+    """
+    Get the most recent IMU events (newest first).
+    Raw captures are omitted unless include_capture is set, to keep listings small.
+    """
+    try:
+        return await MongoDB.get_imu_events(event_type, limit, include_capture, device_id)
+    except Exception as e:
+        logger.error(f"Error retrieving events: {str(e)}", exc_info=True)
+        raise HTTPException(status_code=500, detail=f"Failed to retrieve events: {str(e)}")
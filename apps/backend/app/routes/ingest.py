@@ -0,0 +1,28 @@
+import logging
+from fastapi import APIRouter
+from app.services.admission import Admission
+from app.services.mqtt_bridge import MqttBridge
+from app.services.pipeline import Pipeline
+from app.services.udp_ingest import UdpIngest
+from app.services.wal import IngestLog
+
+logger = logging.getLogger(__name__)
+router = APIRouter(prefix="/api", tags=["ingest"])
+
+
+@router.get("/ingest_status")
+async def get_ingest_status():
+    """
+    Get the state of the ingest path: throughput, queue depth and latency
+    histograms of each pipeline stage, admission queue depth, in-flight writes,
+    the current Retry-After and rejection counters, the write-ahead log's
+    size and replay lag, the UDP listener's counters, and the MQTT bridge's
+    consumer lag and counters.
+    """
+    return {
+        "pipeline": Pipeline.get_stats(),
+        "admission": Admission.get_stats(),
+        "wal": IngestLog.get_stats(),
+        "udp": UdpIngest.get_stats(),
+        "mqtt": MqttBridge.get_stats(),
+    }
@@ -1,44 +1,222 @@
 import logging
-from fastapi import APIRouter, HTTPException
-from app.models.sensor import SensorDataInput, SensorDataOutput
+import time
+from datetime import datetime, timedelta
+from fastapi import APIRouter, Depends, HTTPException, Query, Request
+from fastapi.exceptions import RequestValidationError
+from pydantic import ValidationError
+from app.models.sensor import SensorDataInput, SensorDataOutput, SensorDataBatchInput, SensorDataSummary
+from app.models.orientation import OrientationOutput, OrientationPoint
 from app.database.mongodb import MongoDB
-from typing import List
+from app.services.clock_sync import ClockSync
+from app.services.device_config import DeviceConfigs
+from app.services.devices import DeviceRegistry
+from app.services.admission import Admission, AdmissionRejected
+from app.services.pipeline import Pipeline
+from app.routes.devices import DeviceIdResolver, ingest_device_id
+from app.services.aggregates import summarize
+from app.services.orientation import DEFAULT_BETA, fuse_readings, quaternion_to_euler, tilt_degrees
+from typing import List, Optional
 
 logger = logging.getLogger(__name__)
 router = APIRouter(prefix="/api", tags=["sensors"])
 
 
-@router.post("/send_data", status_code=200)
-async def send_data(data: SensorDataInput):
+# The body is validated by hand in send_data, so describe it for the OpenAPI docs here
+_SEND_DATA_BODY = {
+    "requestBody": {
+        "required": True,
+        "content": {
+            "application/json": {
+                "schema": {
+                    key: value
+                    for key, value in SensorDataInput.model_json_schema(ref_template="#/components/schemas/{model}").items()
+                    if key != "$defs"
+                }
+            }
+        },
+    }
+}
+
+
+@router.post("/send_data", status_code=200, openapi_extra=_SEND_DATA_BODY)
+async def send_data(
+    request: Request,
+    device_id_of: DeviceIdResolver = Depends(ingest_device_id),
+):
     """
     Receive sensor data from embedded system and store in MongoDB.
     Matches exact JSON format from embedded FreeRTOS system.
+    A reading whose seq is already stored is acknowledged without being stored again.
     """
+    # Validate the raw bytes in one pass, instead of parsing them into Python
+    # objects first and validating those, as a declared body parameter would
+    body = await request.body()
+    started = time.perf_counter()
     try:
-        record_id = await MongoDB.insert_sensor_data(data)
-        return {
+        data = SensorDataInput.model_validate_json(body)
+    except ValidationError as e:
+        # Same error shape as a declared body parameter
+        raise RequestValidationError(
+            [{**error, "loc": ("body", *error["loc"])} for error in e.errors(include_url=False)], body=body
+        )
+    Pipeline.observe_decode(time.perf_counter() - started)
+    data.device_id = device_id_of(data.device_id)
+    Admission.check_rate(data.device_id)
+    try:
+        record_id, = await Pipeline.submit([data])
+    except AdmissionRejected:
+        raise
+    except Exception as e:
+        raise HTTPException(status_code=500, detail=f"Failed to store sensor data: {str(e)}")
+    
+    if record_id is None:
+        response = {
+            "status": "success",
+            "message": "Duplicate reading ignored",
+            "id": None,
+            "duplicate": True
+        }
+    else:
+        response = {
             "status": "success",
             "message": "Sensor data stored successfully",
             "id": record_id
         }
-    except Exception as e:
-        raise HTTPException(status_code=500, detail=f"Failed to store sensor data: {str(e)}")
+    # Config changes the board has not applied yet ride on the response
+    config = await DeviceConfigs.pending_changes(data.device_id, data.config_version)
+    if config is not None:
+        response["config"] = config
+    return response
+
+
+@router.post("/send_data_batch", status_code=200)
+async def send_data_batch(
+    batch: SensorDataBatchInput,
+    device_id_of: DeviceIdResolver = Depends(ingest_device_id),
+):
+    """
+    Receive readings buffered on the device while it was offline.
+    Each reading keeps the timestamp it was sampled at on the device.
+    Readings whose seq is already stored are skipped, so a batch can be re-sent safely.
+    """
+    # Every reading is filed under one device, so they must agree on it
+    body_device_ids = {reading.device_id for reading in batch.readings if reading.device_id}
+    if batch.device_id:
+        body_device_ids.add(batch.device_id)
+    if len(body_device_ids) > 1:
+        raise HTTPException(
+            status_code=400,
+            detail=f"A batch must come from a single device, got device_ids {', '.join(sorted(body_device_ids))}",
+        )
+    device_id = device_id_of(next(iter(body_device_ids), None))
+    async with Admission.admit(device_id):
+        try:
+            inserted = await MongoDB.insert_sensor_data_batch(batch.readings, device_id)
+        except Exception as e:
+            raise HTTPException(status_code=500, detail=f"Failed to store sensor data batch: {str(e)}")
+    
+    response = {
+        "status": "success",
+        "message": f"Stored {inserted} buffered sensor readings",
+        "inserted": inserted,
+        "duplicates": len(batch.readings) - inserted
+    }
+    await DeviceRegistry.touch(device_id)
+    config = await DeviceConfigs.pending_changes(device_id, batch.config_version)
+    if config is not None:
+        response["config"] = config
+    return response
 
 
 @router.get("/sensors_data", response_model=List[SensorDataOutput])
-async def get_sensors_data():
+async def get_sensors_data(
+    device_id: Optional[str] = Query(None, description="Only return data from this device")
+):
     """
-    Get all sensor data from MongoDB.
+    Get all sensor data from MongoDB, for every device or a single one.
     Returns all records sorted by timestamp (newest first).
     """
     try:
-        data = await MongoDB.get_all_sensor_data()
+        data = await MongoDB.get_all_sensor_data(device_id)
         return data
     except Exception as e:
         logger.error(f"Error retrieving sensor data: {str(e)}", exc_info=True)
         raise HTTPException(status_code=500, detail=f"Failed to retrieve sensor data: {str(e)}")
 
 
+@router.get("/sensors_summary", response_model=SensorDataSummary)
+async def get_sensors_summary(
+    hours: int = Query(24, ge=1, le=720, description="Size of the window ending now, in hours"),
+    device_id: Optional[str] = Query(None, description="Only return data from this device"),
+):
+    """
+    Get time-weighted mean/min/max for every scalar sensor value over a window.
+    Readings are weighted by the time span they cover, so adaptive sampling
+    (more frequent uploads while a signal is busy) does not bias the result.
+    """
+    end = datetime.utcnow()
+    start = end - timedelta(hours=hours)
+    try:
+        documents = await MongoDB.get_sensor_data_range(start, end, device_id)
+    except Exception as e:
+        logger.error(f"Error retrieving sensor summary: {str(e)}", exc_info=True)
+        raise HTTPException(status_code=500, detail=f"Failed to retrieve sensor summary: {str(e)}")
+    return SensorDataSummary(start=start, end=end, readings=len(documents), fields=summarize(documents))
+
+
+@router.get("/orientation", response_model=OrientationOutput)
+async def get_orientation(
+    hours: int = Query(1, ge=1, le=24, description="Size of the window ending now, in hours"),
+    tilt_threshold_deg: float = Query(30.0, gt=0, le=180, description="Tilt from vertical that raises an alarm"),
+    beta: float = Query(DEFAULT_BETA, gt=0, le=1, description="Madgwick filter gain for server-side fusion"),
+    device_id: Optional[str] = Query(None, description="Only return data from this device"),
+):
+    """
+    Get device orientation over a window as roll/pitch/yaw and tilt from vertical.
+    Readings with an on-device orientation quaternion are used as reported; the
+    rest are fused server-side from stored accelerometer and gyroscope values.
+    """
+    end = datetime.utcnow()
+    start = end - timedelta(hours=hours)
+    try:
+        documents = await MongoDB.get_sensor_data_range(start, end, device_id)
+    except Exception as e:
+        logger.error(f"Error retrieving orientation: {str(e)}", exc_info=True)
+        raise HTTPException(status_code=500, detail=f"Failed to retrieve orientation: {str(e)}")
+
+    points = []
+    for point_device_id, timestamp, q, source in fuse_readings(documents, beta):
+        roll, pitch, yaw = quaternion_to_euler(q)
+        tilt = tilt_degrees(q)
+        points.append(OrientationPoint(
+            device_id=point_device_id,
+            timestamp=timestamp,
+            quaternion={"w": q[0], "x": q[1], "y": q[2], "z": q[3]},
+            roll_deg=round(roll, 2),
+            pitch_deg=round(pitch, 2),
+            yaw_deg=round(yaw, 2),
+            tilt_deg=round(tilt, 2),
+            source=source,
+            tilt_alarm=tilt > tilt_threshold_deg,
+        ))
+    return OrientationOutput(
+        start=start,
+        end=end,
+        tilt_threshold_deg=tilt_threshold_deg,
+        alarms=sum(point.tilt_alarm for point in points),
+        points=points,
+    )
+
+
+@router.get("/clock_sync")
+async def get_clock_sync():
+    """
+    Get the current clock offset and drift estimate for each device.
+    Estimates are kept in memory and rebuilt from incoming readings after a restart.
+    """
+    return ClockSync.get_estimates()
+
+
 @router.get("/database_info")
 async def get_database_info():
     """
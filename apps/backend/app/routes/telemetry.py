@@ -0,0 +1,49 @@
+import logging
+from fastapi import APIRouter, Depends, HTTPException, Query
+from app.models.telemetry import TelemetryInput, TelemetryOutput
+from app.database.mongodb import MongoDB
+from app.services.devices import DeviceRegistry
+from app.services.admission import Admission
+from app.routes.devices import DeviceIdResolver, ingest_device_id
+from typing import List, Optional
+
+logger = logging.getLogger(__name__)
+router = APIRouter(prefix="/api", tags=["telemetry"])
+
+
+@router.post("/send_telemetry", status_code=200)
+async def send_telemetry(
+    data: TelemetryInput,
+    device_id_of: DeviceIdResolver = Depends(ingest_device_id),
+):
+    """
+    Receive a runtime telemetry record (task CPU load, stack watermarks, heap,
+    mutex wait times, upload latency breakdown) from the embedded system.
+    """
+    data.device_id = device_id_of(data.device_id)
+    async with Admission.admit(data.device_id):
+        try:
+            record_id = await MongoDB.insert_telemetry(data)
+        except Exception as e:
+            raise HTTPException(status_code=500, detail=f"Failed to store telemetry: {str(e)}")
+    await DeviceRegistry.touch(data.device_id)
+    return {
+        "status": "success",
+        "message": "Telemetry stored successfully",
+        "id": record_id
+    }
+
+
+@router.get("/telemetry", response_model=List[TelemetryOutput])
+async def get_telemetry(
+    limit: int = Query(100, ge=1, le=1000, description="Maximum number of records to return"),
+    device_id: Optional[str] = Query(None, description="Only return data from this device"),
+):
+    """
+    Get the most recent telemetry records (newest first).
+    """
+    try:
+        return await MongoDB.get_telemetry(limit, device_id)
+    except Exception as e:
+        logger.error(f"Error retrieving telemetry: {str(e)}", exc_info=True)
+        raise HTTPException(status_code=500, detail=f"Failed to retrieve telemetry: {str(e)}")
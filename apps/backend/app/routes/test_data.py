@@ -1,13 +1,34 @@
+import math
 import random
 from datetime import datetime, timedelta
 from fastapi import APIRouter, HTTPException, Query
-from app.models.sensor import SensorDataInput, Accelerometer, Gyroscope
+from app.models.sensor import SensorDataInput, SoundSpectrum, Vector3
 from app.database.mongodb import MongoDB
 from typing import Dict
 
 router = APIRouter(prefix="/api", tags=["test-data"])
 
 
+# A-weighting corrections (dB) at the octave band centres 63 Hz ... 8 kHz
+A_WEIGHTING_DB = (-26.2, -16.1, -8.6, -3.2, 0.0, 1.2, 1.0, -1.1)
+
+
+def generate_test_sound_spectrum() -> SoundSpectrum:
+    """
+    Generate octave band levels typical of an indoor room and derive the
+    dB(A) level from them the same way the device does.
+    """
+    # Pink-ish spectrum: louder in the low bands, falling off towards 8 kHz
+    band_levels = [round(random.uniform(40.0, 50.0) - 2.5 * i, 1) for i in range(len(A_WEIGHTING_DB))]
+    laeq = 10 * math.log10(sum(10 ** ((level + weight) / 10) for level, weight in zip(band_levels, A_WEIGHTING_DB)))
+    return SoundSpectrum(
+        band_levels_db=band_levels,
+        laeq_db=round(laeq, 1),
+        peak_db=round(max(band_levels) + random.uniform(3.0, 15.0), 1),
+        peak_events=random.choice([0, 0, 0, 1, 2]),
+    )
+
+
 def generate_test_sensor_data(base_time: datetime, variation: float = 0.1) -> SensorDataInput:
     """
     Generate realistic test sensor data matching exact embedded system format.
@@ -44,8 +65,9 @@ def generate_test_sensor_data(base_time: datetime, variation: float = 0.1) -> Se
         voc=voc,
         light=light,
         sound=sound,
-        accelerometer=Accelerometer(x=acc_x, y=acc_y, z=acc_z),
-        gyroscope=Gyroscope(x=gyro_x, y=gyro_y, z=gyro_z)
+        accelerometer=Vector3(x=acc_x, y=acc_y, z=acc_z),
+        gyroscope=Vector3(x=gyro_x, y=gyro_y, z=gyro_z),
+        sound_spectrum=generate_test_sound_spectrum()
     )
 
 
@@ -69,23 +91,7 @@ async def generate_random_data() -> Dict:
             "status": "success",
             "message": "Random sensor data generated and stored successfully",
             "id": record_id,
-            "data": {
-                "temperature": test_data.temperature,
-                "humidity": test_data.humidity,
-                "voc": test_data.voc,
-                "light": test_data.light,
-                "sound": test_data.sound,
-                "accelerometer": {
-                    "x": test_data.accelerometer.x,
-                    "y": test_data.accelerometer.y,
-                    "z": test_data.accelerometer.z,
-                },
-                "gyroscope": {
-                    "x": test_data.gyroscope.x,
-                    "y": test_data.gyroscope.y,
-                    "z": test_data.gyroscope.z,
-                },
-            }
+            "data": test_data.model_dump()
         }
     except Exception as e:
         raise HTTPException(status_code=500, detail=f"Failed to generate random data: {str(e)}")
@@ -118,7 +124,7 @@ async def seed_test_data(
         
         # Generate data points going back in time
         now = datetime.utcnow()
-        inserted_count = 0
+        documents = []
         
         for i in range(num_records):
             # Calculate timestamp (going back in time)
@@ -128,42 +134,11 @@ async def seed_test_data(
             # Generate test data
             test_data = generate_test_sensor_data(record_time)
             
-            # Insert into database with custom timestamp
-            document = {
-                "timestamp": record_time,
-                "temperature": test_data.temperature,
-                "humidity": test_data.humidity,
-                "voc": test_data.voc,
-                "light": test_data.light,
-                "sound": test_data.sound,
-                "accelerometer": {
-                    "x": test_data.accelerometer.x,
-                    "y": test_data.accelerometer.y,
-                    "z": test_data.accelerometer.z,
-                },
-                "gyroscope": {
-                    "x": test_data.gyroscope.x,
-                    "y": test_data.gyroscope.y,
-                    "z": test_data.gyroscope.z,
-                },
-            }
-            
-            await MongoDB.ensure_connected()
-            try:
-                await MongoDB.database.sensor_readings.insert_one(document)
-                inserted_count += 1
-            except RuntimeError as e:
-                # Catch "Event loop is closed" errors and retry with fresh connection
-                if "Event loop is closed" in str(e) or "loop is closed" in str(e).lower():
-                    # Reset connection and retry
-                    MongoDB.client = None
-                    MongoDB.database = None
-                    MongoDB._client_loop_id = None
-                    await MongoDB.ensure_connected()
-                    await MongoDB.database.sensor_readings.insert_one(document)
-                    inserted_count += 1
-                else:
-                    raise
+            # Build the document with custom timestamp
+            documents.append(MongoDB.build_sensor_document(test_data, record_time))
+        
+        # Insert in one round trip, in whichever storage layout is configured
+        inserted_count = await MongoDB.insert_sensor_documents(documents)
         
         return {
             "status": "success",
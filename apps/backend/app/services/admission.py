@@ -0,0 +1,170 @@
+import asyncio
+import math
+import os
+import time
+from contextlib import asynccontextmanager
+from dataclasses import dataclass
+from typing import Dict, Optional
+from app.models.sensor import DEFAULT_DEVICE_ID
+
+# Smoothing factor of the moving average of write durations used for Retry-After
+WRITE_TIME_ALPHA = 0.1
+# Retry-After bounds in seconds
+MIN_RETRY_AFTER_S = 1
+MAX_RETRY_AFTER_S = 60
+
+
+@dataclass(frozen=True)
+class AdmissionLimits:
+    max_concurrent_writes: int
+    max_queue: int
+    queue_timeout_s: float
+    device_rate: float
+    device_burst: float
+
+    @classmethod
+    def from_env(cls) -> "AdmissionLimits":
+        return cls(
+            max_concurrent_writes=int(os.getenv("INGEST_MAX_CONCURRENCY", "16")),
+            max_queue=int(os.getenv("INGEST_MAX_QUEUE", "256")),
+            queue_timeout_s=float(os.getenv("INGEST_QUEUE_TIMEOUT", "10")),
+            device_rate=float(os.getenv("INGEST_DEVICE_RATE", "5")),
+            device_burst=float(os.getenv("INGEST_DEVICE_BURST", "20")),
+        )
+
+
+class AdmissionRejected(Exception):
+    """Ingest request turned away; the board should retry after retry_after_s"""
+
+    def __init__(self, reason: str, retry_after_s: int):
+        super().__init__(reason)
+        self.reason = reason
+        self.retry_after_s = retry_after_s
+
+
+class TokenBucket:
+    def __init__(self, burst: float):
+        self.tokens = burst
+        self.updated = time.monotonic()
+
+    def take(self, rate: float, burst: float) -> float:
+        """Take one token. Returns 0 if admitted, otherwise the seconds until a token is available."""
+        now = time.monotonic()
+        self.tokens = min(burst, self.tokens + (now - self.updated) * rate)
+        self.updated = now
+        if self.tokens >= 1:
+            self.tokens -= 1
+            return 0.0
+        return (1 - self.tokens) / rate
+
+
+class Admission:
+    """Admission control in front of ingest writes.
+
+    Each device is rate limited by a token bucket, so a single misbehaving board
+    cannot crowd out the fleet. Admitted requests wait for one of a fixed number
+    of database write slots. If the wait queue is full, or a request waits longer
+    than the queue timeout, it is rejected immediately with a Retry-After derived
+    from the queue depth and recent write times, instead of piling up."""
+    _limits: Optional[AdmissionLimits] = None
+    _semaphore: Optional[asyncio.Semaphore] = None
+    _semaphore_loop_id: Optional[int] = None
+    _buckets: Dict[str, TokenBucket] = {}
+    _waiting = 0
+    _in_flight = 0
+    _avg_write_s = 0.05
+    _stats = {"admitted": 0, "rejected_rate_limit": 0, "rejected_queue_full": 0, "rejected_queue_timeout": 0}
+
+    @classmethod
+    def limits(cls) -> AdmissionLimits:
+        # Read lazily so values from .env (loaded after imports) apply
+        if cls._limits is None:
+            cls._limits = AdmissionLimits.from_env()
+        return cls._limits
+
+    @classmethod
+    def _get_semaphore(cls) -> asyncio.Semaphore:
+        """Write slots, recreated if the event loop changed (serverless invocations)"""
+        loop_id = id(asyncio.get_running_loop())
+        if cls._semaphore is None or cls._semaphore_loop_id != loop_id:
+            cls._semaphore = asyncio.Semaphore(cls.limits().max_concurrent_writes)
+            cls._semaphore_loop_id = loop_id
+            cls._waiting = 0
+            cls._in_flight = 0
+        return cls._semaphore
+
+    @classmethod
+    def retry_after_s(cls) -> int:
+        """Time for the current queue to drain through the write slots"""
+        backlog = cls._waiting + cls._in_flight
+        drain_s = backlog / cls.limits().max_concurrent_writes * cls._avg_write_s
+        return min(MAX_RETRY_AFTER_S, max(MIN_RETRY_AFTER_S, math.ceil(drain_s)))
+
+    @classmethod
+    def _reject(cls, reason: str, stat: str, retry_after_s: int):
+        cls._stats[stat] += 1
+        raise AdmissionRejected(reason, retry_after_s)
+
+    @classmethod
+    @asynccontextmanager
+    async def admit(cls, device_id: Optional[str]):
+        """Hold a database write slot for the duration of the block, or raise AdmissionRejected"""
+        cls.check_rate(device_id)
+        async with cls.write_slot():
+            yield
+
+    @classmethod
+    def check_rate(cls, device_id: Optional[str]):
+        """Take a token from the device's bucket, or raise AdmissionRejected"""
+        limits = cls.limits()
+        key = device_id or DEFAULT_DEVICE_ID
+        bucket = cls._buckets.get(key)
+        if bucket is None:
+            bucket = cls._buckets[key] = TokenBucket(limits.device_burst)
+        wait_s = bucket.take(limits.device_rate, limits.device_burst)
+        if wait_s > 0:
+            cls._reject(f"Rate limit exceeded for device '{key}'", "rejected_rate_limit", max(MIN_RETRY_AFTER_S, math.ceil(wait_s)))
+
+    @classmethod
+    @asynccontextmanager
+    async def write_slot(cls):
+        """Hold a database write slot without a per-device rate check, for writes
+        that carry readings from several devices at once"""
+        limits = cls.limits()
+        semaphore = cls._get_semaphore()
+        if not semaphore.locked():
+            await semaphore.acquire()
+        else:
+            # All write slots are busy: queue, but only up to the bound
+            if cls._waiting >= limits.max_queue:
+                cls._reject("Ingest queue is full", "rejected_queue_full", cls.retry_after_s())
+            cls._waiting += 1
+            try:
+                await asyncio.wait_for(semaphore.acquire(), limits.queue_timeout_s)
+            except asyncio.TimeoutError:
+                cls._reject("Timed out waiting for a write slot", "rejected_queue_timeout", cls.retry_after_s())
+            finally:
+                cls._waiting -= 1
+
+        cls._in_flight += 1
+        cls._stats["admitted"] += 1
+        started = time.monotonic()
+        try:
+            yield
+        finally:
+            cls._avg_write_s += WRITE_TIME_ALPHA * (time.monotonic() - started - cls._avg_write_s)
+            cls._in_flight -= 1
+            semaphore.release()
+
+    @classmethod
+    def get_stats(cls) -> dict:
+        limits = cls.limits()
+        return {
+            "waiting": cls._waiting,
+            "in_flight": cls._in_flight,
+            "max_concurrent_writes": limits.max_concurrent_writes,
+            "max_queue": limits.max_queue,
+            "avg_write_ms": round(cls._avg_write_s * 1000, 3),
+            "retry_after_s": cls.retry_after_s(),
+            **cls._stats,
+        }
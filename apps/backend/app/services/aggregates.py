@@ -0,0 +1,68 @@
+from datetime import datetime
+from typing import Dict, List, Optional
+from app.models.registry import SENSOR_FIELDS, SCALAR_FLOAT, SCALAR_INT, VECTOR3
+
+# Weight of a reading that reports no report_interval_s and has no predecessor:
+# the board's default upload interval
+DEFAULT_INTERVAL_S = 30.0
+# Gaps longer than this are outages, not time the reading represents
+MAX_INTERVAL_S = 600.0
+
+
+def scalar_values(document: dict) -> Dict[str, tuple]:
+    """Scalar values of a reading as {key: (value, rate field name)}; vector axes become 'name.x'"""
+    values = {}
+    for field in SENSOR_FIELDS:
+        value = document.get(field.name)
+        if value is None:
+            continue
+        if field.kind in (SCALAR_FLOAT, SCALAR_INT):
+            values[field.name] = (float(value), field.name)
+        elif field.kind == VECTOR3:
+            for axis in ("x", "y", "z"):
+                values[f"{field.name}.{axis}"] = (float(value[axis]), field.name)
+    return values
+
+
+def summarize(documents: List[dict]) -> Dict[str, dict]:
+    """Time-weighted mean/min/max per scalar field over readings sorted oldest first.
+
+    Each reading stands for the `report_interval_s` it summarises (or, for
+    boards that do not send it, the gap since the previous reading), so an
+    adaptive board that uploads more often while a signal is busy does not
+    skew the mean towards busy periods. The sample estimate uses the
+    per-field `sample_rates_hz` the reading was taken at."""
+    totals: Dict[str, dict] = {}
+    # Gaps are measured between readings of the same device
+    previous_by_device: Dict[Optional[str], datetime] = {}
+    for document in documents:
+        device_id = document.get("device_id")
+        previous = previous_by_device.get(device_id)
+        interval_s = document.get("report_interval_s")
+        if not interval_s:
+            if previous is None:
+                interval_s = DEFAULT_INTERVAL_S
+            else:
+                interval_s = min(max((document["timestamp"] - previous).total_seconds(), 0.0), MAX_INTERVAL_S)
+        previous_by_device[device_id] = document["timestamp"]
+        rates = document.get("sample_rates_hz") or {}
+
+        for key, (value, field_name) in scalar_values(document).items():
+            total = totals.setdefault(key, {"weighted_sum": 0.0, "covered_s": 0.0, "min": value, "max": value, "samples": 0.0})
+            total["weighted_sum"] += value * interval_s
+            total["covered_s"] += interval_s
+            total["min"] = min(total["min"], value)
+            total["max"] = max(total["max"], value)
+            rate = rates.get(field_name)
+            total["samples"] += rate * interval_s if rate else 1.0
+
+    return {
+        key: {
+            "mean": total["weighted_sum"] / total["covered_s"] if total["covered_s"] else total["min"],
+            "min": total["min"],
+            "max": total["max"],
+            "samples": round(total["samples"], 1),
+            "covered_s": round(total["covered_s"], 3),
+        }
+        for key, total in totals.items()
+    }
@@ -0,0 +1,177 @@
+import logging
+import math
+from collections import deque
+from datetime import datetime, timedelta, timezone
+from typing import Dict, List, Optional
+from app.models.sensor import DEFAULT_DEVICE_ID
+
+logger = logging.getLogger(__name__)
+
+# Number of (device time, offset) observations kept per device
+WINDOW_SIZE = 64
+# Number of segments whose minimum offsets form the lower envelope used for the fit
+ENVELOPE_SEGMENTS = 8
+# Device-time span needed before a drift estimate is trusted
+MIN_DRIFT_SPAN_S = 300.0
+# An observation this far below the prediction means the device clock jumped forward (SNTP step)
+RESYNC_THRESHOLD_S = 2.0
+# This many consecutive observations that far above the prediction mean it jumped back
+# (reboot before SNTP sync); a single one may just be a slow upload
+RESYNC_CONSECUTIVE = 5
+
+
+def to_naive_utc(value: datetime) -> datetime:
+    """Normalize a datetime to naive UTC, the form stored in MongoDB"""
+    if value.tzinfo is not None:
+        return value.astimezone(timezone.utc).replace(tzinfo=None)
+    return value
+
+
+def _epoch_seconds(value: datetime) -> float:
+    """Seconds since the Unix epoch for a naive UTC datetime"""
+    return value.replace(tzinfo=timezone.utc).timestamp()
+
+
+class ClockEstimator:
+    """Offset and drift estimate of one device clock relative to server time.
+
+    Each observation is `arrival - device_timestamp`, which is the true clock
+    offset plus a non-negative network/queueing delay. The estimate is a line
+    fitted through the lower envelope (per-segment minima) of recent
+    observations, so it converges on the minimum-delay path and its slope is
+    the clock drift. The estimate is reset when the device clock steps
+    either way."""
+
+    def __init__(self):
+        self._samples = deque(maxlen=WINDOW_SIZE)
+        self._reference_s = 0.0
+        self._intercept_s: Optional[float] = None
+        self._slope = 0.0
+        # Consecutive observations above the prediction by more than RESYNC_THRESHOLD_S
+        self._above: List[tuple] = []
+        self.last_observed_at: Optional[datetime] = None
+
+    @property
+    def offset_s(self) -> Optional[float]:
+        """Offset at the most recent observation, in seconds"""
+        if self._intercept_s is None:
+            return None
+        return self.predict(self._samples[-1][0])
+
+    @property
+    def drift_ppm(self) -> float:
+        return self._slope * 1e6
+
+    @property
+    def sample_count(self) -> int:
+        return len(self._samples)
+
+    def predict(self, device_s: float) -> float:
+        """Predicted offset in seconds at the given device time"""
+        return self._intercept_s + self._slope * (device_s - self._reference_s)
+
+    def observe(self, device_time: datetime, arrival: datetime) -> bool:
+        """Add an observation. Returns False if it is held back as a possible
+        backward step, in which case the estimate does not apply to it."""
+        device_s = _epoch_seconds(device_time)
+        offset_s = (arrival - device_time).total_seconds()
+        self.last_observed_at = arrival
+        if self._intercept_s is not None:
+            error_s = offset_s - self.predict(device_s)
+            if error_s < -RESYNC_THRESHOLD_S:
+                logger.info(f"Device clock stepped forward by {-error_s:.3f}s, resetting estimate")
+                self._samples.clear()
+            elif error_s > RESYNC_THRESHOLD_S:
+                # Either a delayed upload or a clock stepped back; kept out of the fit until it repeats
+                self._above.append((device_s, offset_s))
+                if len(self._above) < RESYNC_CONSECUTIVE:
+                    return False
+                logger.info(f"Device clock stepped back by {error_s:.3f}s, resetting estimate")
+                self._samples.clear()
+                self._samples.extend(self._above[:-1])
+        self._above = []
+        self._samples.append((device_s, offset_s))
+        self._fit()
+        return True
+
+    def _fit(self):
+        samples = list(self._samples)
+        segment_size = math.ceil(len(samples) / min(ENVELOPE_SEGMENTS, len(samples)))
+        envelope = [
+            min(samples[i:i + segment_size], key=lambda sample: sample[1])
+            for i in range(0, len(samples), segment_size)
+        ]
+
+        self._reference_s = envelope[0][0]
+        span_s = envelope[-1][0] - envelope[0][0]
+        if len(envelope) < 2 or span_s < MIN_DRIFT_SPAN_S:
+            self._slope = 0.0
+            self._intercept_s = min(offset for _, offset in envelope)
+            return
+
+        # Least-squares line through the envelope points
+        xs = [device_s - self._reference_s for device_s, _ in envelope]
+        ys = [offset for _, offset in envelope]
+        mean_x = sum(xs) / len(xs)
+        mean_y = sum(ys) / len(ys)
+        variance = sum((x - mean_x) ** 2 for x in xs)
+        self._slope = sum((x - mean_x) * (y - mean_y) for x, y in zip(xs, ys)) / variance
+        self._intercept_s = mean_y - self._slope * mean_x
+
+    def correct(self, device_time: datetime) -> datetime:
+        """Map a device timestamp to server time"""
+        return device_time + timedelta(seconds=self.predict(_epoch_seconds(device_time)))
+
+
+class ClockSync:
+    """Per-device clock estimates, kept in memory for the lifetime of the process"""
+    _estimators: Dict[str, ClockEstimator] = {}
+
+    @classmethod
+    def _estimator(cls, device_id: Optional[str]) -> ClockEstimator:
+        key = device_id or DEFAULT_DEVICE_ID
+        if key not in cls._estimators:
+            cls._estimators[key] = ClockEstimator()
+        return cls._estimators[key]
+
+    @classmethod
+    def stamp(cls, device_id: Optional[str], device_time: Optional[datetime], received_at: datetime) -> datetime:
+        """Return the server-time timestamp for a live reading and update the
+        device's estimate with it. Readings without a device timestamp are
+        stamped with the arrival time."""
+        if device_time is None:
+            return received_at
+        device_time = to_naive_utc(device_time)
+        estimator = cls._estimator(device_id)
+        if not estimator.observe(device_time, received_at):
+            # Off by at most the upload delay, rather than by a clock step
+            return received_at
+        # Never place a reading after the moment it arrived
+        return min(estimator.correct(device_time), received_at)
+
+    @classmethod
+    def correct_buffered(cls, device_id: Optional[str], device_times: List[datetime]) -> List[datetime]:
+        """Map timestamps of readings replayed from the device's buffer onto server time.
+
+        Buffered readings spent an unknown time on the device, so they are not
+        used as observations. They are corrected with the estimate built from
+        live readings, or kept as reported if there is none yet."""
+        estimator = cls._estimators.get(device_id or DEFAULT_DEVICE_ID)
+        device_times = [to_naive_utc(value) for value in device_times]
+        if estimator is None or estimator.offset_s is None:
+            return device_times
+        return [estimator.correct(value) for value in device_times]
+
+    @classmethod
+    def get_estimates(cls) -> Dict[str, dict]:
+        """Current offset/drift estimate for every device seen by this process"""
+        return {
+            device_id: {
+                "offset_ms": round(estimator.offset_s * 1000, 3),
+                "drift_ppm": round(estimator.drift_ppm, 3),
+                "samples": estimator.sample_count,
+                "last_observed_at": estimator.last_observed_at,
+            }
+            for device_id, estimator in cls._estimators.items()
+            if estimator.offset_s is not None
+        }
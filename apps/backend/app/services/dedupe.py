@@ -0,0 +1,58 @@
+from typing import Dict, Iterable, Optional
+from app.models.sensor import DEFAULT_DEVICE_ID
+
+# Number of sequence numbers below the highest one whose state is tracked per device.
+# Older ones fall through to the database's unique index.
+WINDOW_SIZE = 4096
+
+
+class SequenceWindow:
+    """Sliding window of recently stored sequence numbers for one device.
+
+    Bit i of the mask is set if `highest - i` has been stored, the same layout
+    as an anti-replay window, so each device costs one integer of WINDOW_SIZE
+    bits however many readings it uploads."""
+
+    def __init__(self):
+        self.highest: Optional[int] = None
+        self.mask = 0
+
+    def seen(self, seq: int) -> bool:
+        """True if seq is known to be stored. False means new or unknown,
+        which the unique index resolves."""
+        if self.highest is None or seq > self.highest:
+            return False
+        offset = self.highest - seq
+        return offset < WINDOW_SIZE and bool(self.mask >> offset & 1)
+
+    def mark(self, seq: int):
+        if self.highest is None:
+            self.highest, self.mask = seq, 1
+        elif seq - self.highest >= WINDOW_SIZE:
+            # Every tracked seq falls out of the window; don't build a shift of the whole jump
+            self.highest, self.mask = seq, 1
+        elif seq > self.highest:
+            self.mask = ((self.mask << (seq - self.highest)) | 1) & ((1 << WINDOW_SIZE) - 1)
+            self.highest = seq
+        elif self.highest - seq < WINDOW_SIZE:
+            self.mask |= 1 << (self.highest - seq)
+
+
+class SequenceWindows:
+    """Per-device sequence windows, kept in memory for the lifetime of the process.
+    Retries and replays of recent readings are dropped without a database round
+    trip; after a restart the unique (device_id, seq) index catches them instead."""
+    _windows: Dict[str, SequenceWindow] = {}
+
+    @classmethod
+    def seen(cls, device_id: Optional[str], seq: int) -> bool:
+        window = cls._windows.get(device_id or DEFAULT_DEVICE_ID)
+        return window is not None and window.seen(seq)
+
+    @classmethod
+    def mark(cls, device_id: Optional[str], seqs: Iterable[int]):
+        key = device_id or DEFAULT_DEVICE_ID
+        if key not in cls._windows:
+            cls._windows[key] = SequenceWindow()
+        for seq in seqs:
+            cls._windows[key].mark(seq)
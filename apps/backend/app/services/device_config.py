@@ -0,0 +1,53 @@
+import logging
+import time
+from typing import Dict, Optional, Tuple
+from app.database.mongodb import MongoDB
+from app.models.sensor import DEFAULT_DEVICE_ID
+
+logger = logging.getLogger(__name__)
+
+# How long a config document is served from memory before it is re-read
+CACHE_TTL_S = 30.0
+
+
+class DeviceConfigs:
+    """Per-device runtime config with a short-lived cache, so piggybacking
+    config changes on ingest responses does not add a query per upload"""
+    _cache: Dict[str, Tuple[float, Optional[dict]]] = {}
+
+    @classmethod
+    async def get(cls, device_id: Optional[str]) -> Optional[dict]:
+        key = device_id or DEFAULT_DEVICE_ID
+        cached = cls._cache.get(key)
+        if cached is not None and time.monotonic() - cached[0] < CACHE_TTL_S:
+            return cached[1]
+        document = await MongoDB.get_device_config(key)
+        cls._cache[key] = (time.monotonic(), document)
+        return document
+
+    @classmethod
+    async def update(cls, device_id: str, values: dict) -> dict:
+        document = await MongoDB.update_device_config(device_id, values)
+        cls._cache[device_id] = (time.monotonic(), document)
+        return document
+
+    @classmethod
+    async def pending_changes(cls, device_id: Optional[str], running_version: Optional[int]) -> Optional[dict]:
+        """Config settings the board has not applied yet, for the ingest response.
+
+        Returns None when the board is up to date or no config exists. A board
+        that does not report a version receives every setting. Lookup failures
+        are logged and never fail the ingest request."""
+        try:
+            document = await cls.get(device_id)
+        except Exception as e:
+            logger.warning(f"Could not load device config: {str(e)}")
+            return None
+        if document is None or (running_version is not None and running_version >= document["version"]):
+            return None
+        changes = {
+            key: value
+            for key, value in document["values"].items()
+            if running_version is None or document["changed_in"].get(key, 0) > running_version
+        }
+        return {"version": document["version"], "changes": changes}
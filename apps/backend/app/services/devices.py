@@ -0,0 +1,34 @@
+import logging
+import time
+from datetime import datetime
+from typing import Dict, Optional
+from app.database.mongodb import MongoDB
+from app.models.sensor import DEFAULT_DEVICE_ID
+
+logger = logging.getLogger(__name__)
+
+# Minimum time between last_seen writes for the same device
+TOUCH_INTERVAL_S = 60.0
+
+
+class DeviceRegistry:
+    """Registers devices on first contact and keeps their last_seen time.
+    Writes are throttled per device, so a board uploading every second costs
+    one registry write per TOUCH_INTERVAL_S rather than one per upload."""
+    _last_touched: Dict[str, float] = {}
+
+    @classmethod
+    async def touch(cls, device_id: Optional[str]):
+        """Record that a device uploaded. Failures are logged and never fail the ingest request."""
+        key = device_id or DEFAULT_DEVICE_ID
+        now = time.monotonic()
+        last = cls._last_touched.get(key)
+        if last is not None and now - last < TOUCH_INTERVAL_S:
+            return
+        # Claim the slot before awaiting so concurrent uploads do not write twice
+        cls._last_touched[key] = now
+        try:
+            await MongoDB.touch_device(key, datetime.utcnow())
+        except Exception as e:
+            cls._last_touched.pop(key, None)
+            logger.warning(f"Could not update device registry: {str(e)}")
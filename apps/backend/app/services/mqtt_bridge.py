@@ -0,0 +1,368 @@
+import asyncio
+import logging
+import os
+import socket
+import ssl
+import struct
+import time
+from collections import deque
+from dataclasses import dataclass
+from datetime import datetime
+from typing import Deque, Dict, Optional, Tuple
+from urllib.parse import urlparse
+from pydantic import ValidationError
+from pymongo.errors import ConnectionFailure
+from app.models.sensor import SensorDataInput
+from app.services.admission import Admission, AdmissionRejected
+from app.services.pipeline import Pipeline
+from app.services.udp_ingest import FRAME_VERSION, FrameError, decode_reading
+
+logger = logging.getLogger(__name__)
+
+# MQTT 3.1.1 control packet types (upper nibble of the fixed header)
+CONNECT = 0x10
+CONNACK = 0x20
+PUBLISH = 0x30
+PUBACK = 0x40
+SUBSCRIBE = 0x82
+SUBACK = 0x90
+PINGREQ = 0xC0
+PINGRESP = 0xD0
+DISCONNECT = 0xE0
+
+RECONNECT_MIN_S = 1.0
+RECONNECT_MAX_S = 30.0
+# Attempts to store a reading that fails for a reason other than an unreachable database
+MAX_STORE_ATTEMPTS = 3
+
+
+class MqttError(Exception):
+    pass
+
+
+def _encode_length(length: int) -> bytes:
+    """MQTT variable-length 'remaining length'"""
+    encoded = bytearray()
+    while True:
+        byte, length = length % 128, length // 128
+        encoded.append(byte | 0x80 if length else byte)
+        if not length:
+            return bytes(encoded)
+
+
+def _encode_string(value: str) -> bytes:
+    data = value.encode()
+    return struct.pack("!H", len(data)) + data
+
+
+def _packet(header: int, body: bytes) -> bytes:
+    return bytes([header]) + _encode_length(len(body)) + body
+
+
+async def _read_packet(reader: asyncio.StreamReader) -> Tuple[int, bytes]:
+    header = (await reader.readexactly(1))[0]
+    length, shift = 0, 0
+    while True:
+        byte = (await reader.readexactly(1))[0]
+        length += (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            break
+    return header, await reader.readexactly(length)
+
+
+@dataclass(frozen=True)
+class BridgeSettings:
+    host: str
+    port: int
+    tls: bool
+    username: Optional[str]
+    password: Optional[str]
+    topic: str
+    shared_group: Optional[str]
+    client_id: str
+    keepalive_s: int
+    max_pending: int
+
+    @classmethod
+    def from_env(cls) -> "BridgeSettings":
+        url = urlparse(os.getenv("MQTT_BROKER_URL"))
+        if url.scheme not in ("mqtt", "mqtts"):
+            raise ValueError("MQTT_BROKER_URL must start with mqtt:// or mqtts://")
+        return cls(
+            host=url.hostname,
+            port=url.port or (8883 if url.scheme == "mqtts" else 1883),
+            tls=url.scheme == "mqtts",
+            username=url.username,
+            password=url.password,
+            topic=os.getenv("MQTT_TOPIC", "devices/+/readings"),
+            shared_group=os.getenv("MQTT_SHARED_GROUP") or None,
+            # Stable across restarts, so a restarted bridge resumes its session and gets its unacknowledged messages
+            client_id=os.getenv("MQTT_CLIENT_ID") or f"ingest-{os.getenv('MQTT_SHARED_GROUP') or 'bridge'}-{socket.gethostname()}",
+            keepalive_s=int(os.getenv("MQTT_KEEPALIVE", "30")),
+            max_pending=int(os.getenv("MQTT_MAX_PENDING", "2000")),
+        )
+
+    @property
+    def subscription(self) -> str:
+        """Topic filter to subscribe; with a shared group the broker spreads
+        messages across every bridge subscribed under the same group"""
+        if self.shared_group:
+            return f"$share/{self.shared_group}/{self.topic}"
+        return self.topic
+
+
+def device_id_from_topic(topic_filter: str, topic: str) -> Optional[str]:
+    """The device id is the topic level matched by the '+' wildcard"""
+    filter_levels = topic_filter.split("/")
+    levels = topic.split("/")
+    if len(levels) != len(filter_levels) or "+" not in filter_levels:
+        return None
+    return levels[filter_levels.index("+")] or None
+
+
+def decode_payload(payload: bytes, device_id: str) -> SensorDataInput:
+    """Decode a JSON reading (the send_data body) or a binary UDP ingest frame"""
+    if payload[:1] == bytes([FRAME_VERSION]):
+        secret = os.getenv("UDP_INGEST_SECRET")
+        if not secret:
+            raise ValueError("Binary payloads need UDP_INGEST_SECRET")
+        reading, _ = decode_reading(secret.encode(), payload)
+    else:
+        reading = SensorDataInput.model_validate_json(payload)
+    if reading.device_id is None:
+        reading.device_id = device_id
+    elif reading.device_id != device_id:
+        raise ValueError(f"Payload device_id '{reading.device_id}' does not match topic device '{device_id}'")
+    return reading
+
+
+@dataclass
+class PendingAck:
+    """A received QoS 1 message whose PUBACK has not been sent"""
+    packet_id: int
+    done: bool = False
+
+
+class MqttBridge:
+    """Subscribes to device reading topics and stores the readings.
+
+    Readings go through the ingest pipeline, whose persist stage writes them
+    in batches. Messages are received at QoS 1 and acknowledged only once
+    stored, so when a bridge dies first the broker redelivers the messages
+    once it reconnects with the same client id. Redeliveries are caught by
+    the usual seq deduplication. Readings are stored concurrently, but PUBACKs
+    go out in the order the messages arrived, as MQTT 3.1.1 requires
+    [MQTT-4.6.0-2]. Each device is held to the same rate limit as over HTTP;
+    a reading over it waits, unacknowledged, until the device has a token.
+    Only the parts of MQTT 3.1.1 a subscriber needs are implemented, which
+    avoids a client library dependency."""
+    _settings: Optional[BridgeSettings] = None
+    _writer: Optional[asyncio.StreamWriter] = None
+    _generation = 0
+    _consumer: Optional[asyncio.Task] = None
+    # Bounds the readings awaiting storage; once they are all taken the bridge stops reading from the broker
+    _slots: Optional[asyncio.Semaphore] = None
+    # Readings awaiting storage, with the monotonic time they were received
+    _pending: Dict[asyncio.Task, float] = {}
+    # QoS 1 messages of the current connection in arrival order; acks are sent from the head
+    _unacked: Deque[PendingAck] = deque()
+    _connected = False
+    _stats = {"received": 0, "stored": 0, "duplicates": 0, "rejected_invalid": 0, "failed": 0, "reconnects": 0}
+
+    @staticmethod
+    def enabled() -> bool:
+        return bool(os.getenv("MQTT_BROKER_URL"))
+
+    @classmethod
+    async def start(cls):
+        cls._settings = BridgeSettings.from_env()
+        cls._slots = asyncio.Semaphore(cls._settings.max_pending)
+        cls._consumer = asyncio.create_task(cls._consume())
+
+    @classmethod
+    async def stop(cls):
+        if cls._consumer is not None:
+            cls._consumer.cancel()
+            cls._consumer = None
+        # Unacknowledged readings are redelivered to the next bridge
+        for task in list(cls._pending):
+            task.cancel()
+        if cls._writer is not None:
+            try:
+                cls._writer.write(_packet(DISCONNECT, b""))
+                cls._writer.close()
+            except Exception:
+                pass
+            cls._writer = None
+
+    @classmethod
+    async def _consume(cls):
+        """Keep a broker connection and feed received readings to the queue"""
+        backoff_s = RECONNECT_MIN_S
+        while True:
+            try:
+                await cls._session()
+            except asyncio.CancelledError:
+                raise
+            except Exception as e:
+                if cls._connected:
+                    # The session worked, so start backing off from scratch
+                    backoff_s = RECONNECT_MIN_S
+                logger.warning(f"MQTT bridge disconnected, reconnecting in {backoff_s:.0f}s: {str(e)}")
+            cls._connected = False
+            cls._writer = None
+            cls._stats["reconnects"] += 1
+            await asyncio.sleep(backoff_s)
+            backoff_s = min(backoff_s * 2, RECONNECT_MAX_S)
+
+    @classmethod
+    async def _session(cls):
+        settings = cls._settings
+        reader, writer = await asyncio.open_connection(
+            settings.host, settings.port, ssl=ssl.create_default_context() if settings.tls else None
+        )
+        try:
+            # Persistent session (clean session off): QoS 1 messages published
+            # while the bridge is away are kept by the broker
+            flags = 0
+            payload = _encode_string(settings.client_id)
+            if settings.username:
+                flags |= 0x80
+                payload += _encode_string(settings.username)
+            if settings.password:
+                flags |= 0x40
+                payload += _encode_string(settings.password)
+            writer.write(_packet(CONNECT, _encode_string("MQTT") + struct.pack("!BBH", 4, flags, settings.keepalive_s) + payload))
+            header, body = await asyncio.wait_for(_read_packet(reader), settings.keepalive_s)
+            if header != CONNACK or body[1] != 0:
+                raise MqttError(f"Connection refused (code {body[1] if len(body) > 1 else '?'})")
+
+            writer.write(_packet(SUBSCRIBE, struct.pack("!H", 1) + _encode_string(settings.subscription) + bytes([1])))
+            cls._generation += 1
+            # Acks still owed on the old connection are void; the broker redelivers those messages
+            cls._unacked = deque()
+            cls._writer = writer
+            cls._connected = True
+            logger.info(f"MQTT bridge subscribed to '{settings.subscription}' on {settings.host}:{settings.port}")
+
+            pinger = asyncio.create_task(cls._ping(writer, settings.keepalive_s))
+            try:
+                while True:
+                    # The broker answers pings, so silence for 1.5 keepalives means the link is dead
+                    header, body = await asyncio.wait_for(_read_packet(reader), settings.keepalive_s * 1.5)
+                    packet_type = header & 0xF0
+                    if packet_type == PUBLISH:
+                        await cls._on_publish(header, body)
+                    elif packet_type == SUBACK and body[-1] == 0x80:
+                        raise MqttError(f"Subscription to '{settings.subscription}' refused")
+            finally:
+                pinger.cancel()
+        finally:
+            writer.close()
+
+    @staticmethod
+    async def _ping(writer: asyncio.StreamWriter, keepalive_s: int):
+        while True:
+            await asyncio.sleep(keepalive_s / 2)
+            writer.write(_packet(PINGREQ, b""))
+
+    @classmethod
+    async def _on_publish(cls, header: int, body: bytes):
+        qos = (header >> 1) & 0x03
+        (topic_length,) = struct.unpack_from("!H", body)
+        raw_topic = body[2:2 + topic_length]
+        offset = 2 + topic_length
+        packet_id = None
+        if qos > 0:
+            (packet_id,) = struct.unpack_from("!H", body, offset)
+            offset += 2
+        payload = body[offset:]
+        cls._stats["received"] += 1
+        pending_ack = None
+        if packet_id is not None:
+            pending_ack = PendingAck(packet_id)
+            cls._unacked.append(pending_ack)
+
+        started = time.perf_counter()
+        try:
+            topic = raw_topic.decode()
+            device_id = device_id_from_topic(cls._settings.topic, topic)
+            if device_id is None:
+                raise ValueError(f"No device id in topic '{topic}'")
+            reading = decode_payload(payload, device_id)
+            Pipeline.observe_decode(time.perf_counter() - started)
+        except (ValueError, FrameError, ValidationError) as e:
+            # Acknowledge so the broker does not redeliver a message that can never be stored
+            cls._stats["rejected_invalid"] += 1
+            logger.debug(f"Dropped MQTT message on '{raw_topic.decode(errors='replace')}': {str(e)}")
+            cls._ack(pending_ack, cls._generation)
+            return
+
+        await cls._slots.acquire()
+        task = asyncio.create_task(cls._store(reading, datetime.utcnow(), pending_ack, cls._generation))
+        cls._pending[task] = time.monotonic()
+        task.add_done_callback(cls._stored)
+
+    @classmethod
+    def _stored(cls, task: asyncio.Task):
+        del cls._pending[task]
+        cls._slots.release()
+
+    @classmethod
+    def _ack(cls, pending_ack: Optional[PendingAck], generation: int):
+        """Mark a message handled and send every PUBACK now due, in arrival order"""
+        # Packet ids belong to a connection; after a reconnect the broker redelivers instead
+        if pending_ack is None or generation != cls._generation:
+            return
+        pending_ack.done = True
+        while cls._unacked and cls._unacked[0].done:
+            packet_id = cls._unacked.popleft().packet_id
+            if cls._writer is not None:
+                cls._writer.write(_packet(PUBACK, struct.pack("!H", packet_id)))
+
+    @classmethod
+    async def _store(cls, reading: SensorDataInput, received_at: datetime, pending_ack: Optional[PendingAck], generation: int):
+        """Store a reading, then acknowledge it. While the database is unreachable,
+        the backend busy or the device over its rate limit the reading is retried
+        for as long as it takes; any other failure is retried a few times, then
+        the message is dropped."""
+        backoff_s = RECONNECT_MIN_S
+        attempts = 0
+        while True:
+            try:
+                Admission.check_rate(reading.device_id)
+                record_id, = await Pipeline.submit([reading], received_at)
+                break
+            except AdmissionRejected as e:
+                await asyncio.sleep(e.retry_after_s)
+                continue
+            except ConnectionFailure:
+                pass
+            except Exception as e:
+                attempts += 1
+                if attempts >= MAX_STORE_ATTEMPTS:
+                    # Acknowledge, or the broker would redeliver a reading that can never be stored
+                    cls._stats["failed"] += 1
+                    logger.error(f"Dropped MQTT reading from '{reading.device_id}' after {attempts} attempts: {str(e)}")
+                    cls._ack(pending_ack, generation)
+                    return
+            # The pipeline has logged the error
+            await asyncio.sleep(backoff_s)
+            backoff_s = min(backoff_s * 2, RECONNECT_MAX_S)
+        cls._stats["stored" if record_id is not None else "duplicates"] += 1
+        cls._ack(pending_ack, generation)
+
+    @classmethod
+    def get_stats(cls) -> dict:
+        if not cls.enabled() or cls._settings is None:
+            return {"enabled": False}
+        return {
+            "enabled": True,
+            "connected": cls._connected,
+            "subscription": cls._settings.subscription,
+            "pending": len(cls._pending),
+            # Consumer lag: how long the oldest received but unstored reading has waited
+            "lag_s": round(time.monotonic() - min(cls._pending.values()), 3) if cls._pending else 0.0,
+            **cls._stats,
+        }
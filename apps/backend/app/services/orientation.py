@@ -0,0 +1,119 @@
+import math
+from datetime import datetime
+from typing import Dict, List, Optional, Tuple
+
+Quaternion = Tuple[float, float, float, float]
+
+# Default Madgwick gain: trades gyro drift correction against accelerometer noise
+DEFAULT_BETA = 0.1
+# Longer gaps between readings cannot be bridged by integrating the gyroscope;
+# the filter is re-seeded from the accelerometer instead
+MAX_STEP_S = 1.0
+
+
+def _normalize(q: Quaternion) -> Quaternion:
+    norm = math.sqrt(sum(component * component for component in q))
+    return tuple(component / norm for component in q)
+
+
+def quaternion_from_accelerometer(ax: float, ay: float, az: float) -> Quaternion:
+    """Orientation with zero yaw whose roll/pitch align the body z axis with gravity"""
+    roll = math.atan2(ay, az)
+    pitch = math.atan2(-ax, math.sqrt(ay * ay + az * az))
+    cr, sr = math.cos(roll / 2), math.sin(roll / 2)
+    cp, sp = math.cos(pitch / 2), math.sin(pitch / 2)
+    return (cr * cp, sr * cp, cr * sp, -sr * sp)
+
+
+def quaternion_to_euler(q: Quaternion) -> Tuple[float, float, float]:
+    """(roll, pitch, yaw) in degrees"""
+    w, x, y, z = q
+    roll = math.atan2(2 * (w * x + y * z), 1 - 2 * (x * x + y * y))
+    pitch = math.asin(max(-1.0, min(1.0, 2 * (w * y - z * x))))
+    yaw = math.atan2(2 * (w * z + x * y), 1 - 2 * (y * y + z * z))
+    return math.degrees(roll), math.degrees(pitch), math.degrees(yaw)
+
+
+def tilt_degrees(q: Quaternion) -> float:
+    """Angle between the body z axis and vertical"""
+    w, x, y, z = q
+    return math.degrees(math.acos(max(-1.0, min(1.0, 1 - 2 * (x * x + y * y)))))
+
+
+class MadgwickFilter:
+    """Madgwick IMU (accelerometer + gyroscope) orientation filter.
+
+    Gradient-descent fusion from Madgwick's 2010 report, in floating point,
+    with gain beta (DEFAULT_BETA unless given). Used to compute orientation
+    from stored readings that do not carry one."""
+
+    def __init__(self, beta: float = DEFAULT_BETA, q: Quaternion = (1.0, 0.0, 0.0, 0.0)):
+        self.beta = beta
+        self.q = q
+
+    def update(self, gyro: Tuple[float, float, float], accel: Tuple[float, float, float], dt: float) -> Quaternion:
+        """Advance by dt seconds with gyroscope (rad/s) and accelerometer (any unit) samples"""
+        q0, q1, q2, q3 = self.q
+        gx, gy, gz = gyro
+        ax, ay, az = accel
+
+        # Rate of change of the quaternion from the gyroscope
+        dq0 = 0.5 * (-q1 * gx - q2 * gy - q3 * gz)
+        dq1 = 0.5 * (q0 * gx + q2 * gz - q3 * gy)
+        dq2 = 0.5 * (q0 * gy - q1 * gz + q3 * gx)
+        dq3 = 0.5 * (q0 * gz + q1 * gy - q2 * gx)
+
+        norm = math.sqrt(ax * ax + ay * ay + az * az)
+        if norm > 0:
+            ax, ay, az = ax / norm, ay / norm, az / norm
+            # Gradient descent step towards the orientation that explains gravity
+            s0 = 4 * q0 * q2 * q2 + 2 * q2 * ax + 4 * q0 * q1 * q1 - 2 * q1 * ay
+            s1 = (4 * q1 * q3 * q3 - 2 * q3 * ax + 4 * q0 * q0 * q1 - 2 * q0 * ay - 4 * q1
+                  + 8 * q1 * q1 * q1 + 8 * q1 * q2 * q2 + 4 * q1 * az)
+            s2 = (4 * q0 * q0 * q2 + 2 * q0 * ax + 4 * q2 * q3 * q3 - 2 * q3 * ay - 4 * q2
+                  + 8 * q2 * q1 * q1 + 8 * q2 * q2 * q2 + 4 * q2 * az)
+            s3 = 4 * q1 * q1 * q3 - 2 * q1 * ax + 4 * q2 * q2 * q3 - 2 * q2 * ay
+            step_norm = math.sqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3)
+            if step_norm > 0:
+                dq0 -= self.beta * s0 / step_norm
+                dq1 -= self.beta * s1 / step_norm
+                dq2 -= self.beta * s2 / step_norm
+                dq3 -= self.beta * s3 / step_norm
+
+        self.q = _normalize((q0 + dq0 * dt, q1 + dq1 * dt, q2 + dq2 * dt, q3 + dq3 * dt))
+        return self.q
+
+
+def fuse_readings(documents: List[dict], beta: float = DEFAULT_BETA) -> List[Tuple[Optional[str], datetime, Quaternion, str]]:
+    """Orientation for each reading, sorted oldest first.
+
+    Readings that carry an on-device `orientation` quaternion use it as-is and
+    re-seed the filter; the rest are fused server-side from their accelerometer
+    and gyroscope values. Each device has its own filter. Returns
+    (device_id, timestamp, quaternion, source) tuples."""
+    results = []
+    filters: Dict[Optional[str], MadgwickFilter] = {}
+    previous_by_device: Dict[Optional[str], datetime] = {}
+    for document in documents:
+        device_id = document.get("device_id")
+        timestamp = document["timestamp"]
+        previous = previous_by_device.get(device_id)
+        previous_by_device[device_id] = timestamp
+        orientation = document.get("orientation")
+        accel = document.get("accelerometer")
+        gyro = document.get("gyroscope")
+
+        if orientation is not None:
+            q = _normalize((orientation["w"], orientation["x"], orientation["y"], orientation["z"]))
+            filters[device_id] = MadgwickFilter(beta, q)
+            results.append((device_id, timestamp, q, "device"))
+        elif accel is not None and gyro is not None:
+            accel = (accel["x"], accel["y"], accel["z"])
+            fusion = filters.get(device_id)
+            dt = (timestamp - previous).total_seconds() if previous is not None else None
+            if fusion is None or dt is None or not 0 < dt <= MAX_STEP_S:
+                fusion = filters[device_id] = MadgwickFilter(beta, quaternion_from_accelerometer(*accel))
+            else:
+                fusion.update((gyro["x"], gyro["y"], gyro["z"]), accel, dt)
+            results.append((device_id, timestamp, fusion.q, "server"))
+    return results
@@ -0,0 +1,367 @@
+import asyncio
+import bisect
+import logging
+import math
+import os
+import time
+from collections import deque
+from dataclasses import dataclass, field
+from datetime import datetime
+from typing import Awaitable, Callable, Dict, List, Optional
+from app.database.mongodb import MongoDB
+from app.models.sensor import SensorDataInput
+from app.services.admission import MAX_RETRY_AFTER_S, MIN_RETRY_AFTER_S, Admission, AdmissionRejected
+from app.services.dedupe import SequenceWindows
+from app.services.devices import DeviceRegistry
+
+logger = logging.getLogger(__name__)
+
+# Upper bounds of the latency histogram buckets, in milliseconds
+LATENCY_BOUNDS_MS = (0.1, 0.25, 0.5, 1, 2.5, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000)
+# Throughput is averaged over this many one-second slots
+RATE_WINDOW_S = 10
+# Concurrent batch writes of the persist stage
+PERSIST_WORKERS = 4
+
+
+class Histogram:
+    """Fixed-bucket latency histogram"""
+
+    def __init__(self):
+        self.counts = [0] * (len(LATENCY_BOUNDS_MS) + 1)
+        self.count = 0
+        self.total_ms = 0.0
+
+    def observe(self, seconds: float):
+        value_ms = seconds * 1000
+        self.counts[bisect.bisect_left(LATENCY_BOUNDS_MS, value_ms)] += 1
+        self.count += 1
+        self.total_ms += value_ms
+
+    def quantile(self, q: float) -> Optional[float]:
+        """Upper bound of the bucket holding the q-quantile"""
+        if not self.count:
+            return None
+        rank = q * self.count
+        seen = 0
+        for bound, count in zip(LATENCY_BOUNDS_MS + (float("inf"),), self.counts):
+            seen += count
+            if seen >= rank:
+                return bound
+        return None
+
+    def snapshot(self) -> dict:
+        return {
+            "count": self.count,
+            "mean_ms": round(self.total_ms / self.count, 3) if self.count else None,
+            "p50_ms": self.quantile(0.5),
+            "p95_ms": self.quantile(0.95),
+            "p99_ms": self.quantile(0.99),
+            # Cumulative counts per upper bound, Prometheus style
+            "buckets": {
+                str(bound): sum(self.counts[:index + 1])
+                for index, bound in enumerate(LATENCY_BOUNDS_MS + ("+Inf",))
+            },
+        }
+
+
+class RateMeter:
+    """Items per second over the last RATE_WINDOW_S seconds"""
+
+    def __init__(self):
+        self.slots = deque(maxlen=RATE_WINDOW_S)
+
+    def add(self, count: int):
+        second = int(time.monotonic())
+        if self.slots and self.slots[-1][0] == second:
+            self.slots[-1][1] += count
+        else:
+            self.slots.append([second, count])
+
+    def per_second(self) -> float:
+        now = int(time.monotonic())
+        return round(sum(count for second, count in self.slots if now - second < RATE_WINDOW_S) / RATE_WINDOW_S, 3)
+
+
+@dataclass
+class PipelineItem:
+    reading: Optional[SensorDataInput]
+    received_at: datetime
+    document: Optional[dict] = None
+    # Resolved with the stored id (None for a duplicate) once persisted
+    future: Optional[asyncio.Future] = None
+    enqueued_at: float = field(default_factory=time.monotonic)
+
+
+Handler = Callable[[List[PipelineItem]], Awaitable[List[PipelineItem]]]
+
+
+class Stage:
+    """A pipeline stage: a bounded queue drained in batches by its workers.
+
+    A worker takes every queued item up to the batch size, so batches grow
+    with load and a lone reading is never held back waiting for company. The
+    handler returns the items to pass to the next stage."""
+
+    def __init__(self, name: str, handler: Handler, queue_size: int, batch_size: int, workers: int = 1):
+        self.name = name
+        self.handler = handler
+        self.queue_size = queue_size
+        self.batch_size = batch_size
+        self.workers = workers
+        self.next: Optional["Stage"] = None
+        self.queue: Optional[asyncio.Queue] = None
+        self.tasks: List[asyncio.Task] = []
+        # Batches being handled right now
+        self.active = 0
+        self.wait = Histogram()
+        self.service = Histogram()
+        self.rate = RateMeter()
+        self.stats = {"processed": 0, "batches": 0, "failed": 0, "dropped": 0}
+
+    def start(self):
+        self.queue = asyncio.Queue(maxsize=self.queue_size)
+        self.tasks = [asyncio.create_task(self._work()) for _ in range(self.workers)]
+
+    def stop(self):
+        for task in self.tasks:
+            task.cancel()
+        self.tasks = []
+
+    async def _work(self):
+        while True:
+            batch = [await self.queue.get()]
+            while len(batch) < self.batch_size and not self.queue.empty():
+                batch.append(self.queue.get_nowait())
+            started = time.monotonic()
+            for item in batch:
+                self.wait.observe(started - item.enqueued_at)
+            self.active += 1
+            try:
+                forwarded = await self.handler(batch)
+            except Exception as e:
+                self.stats["failed"] += len(batch)
+                logger.error(
+                    f"Ingest stage '{self.name}' failed on {len(batch)} readings: {str(e)}",
+                    exc_info=not isinstance(e, AdmissionRejected),
+                )
+                # Readings not persisted yet are still awaited by their request
+                for item in batch:
+                    if item.future is not None and not item.future.done():
+                        item.future.set_exception(e)
+                forwarded = []
+            finally:
+                self.active -= 1
+            self.service.observe(time.monotonic() - started)
+            self.stats["processed"] += len(batch)
+            self.stats["batches"] += 1
+            self.rate.add(len(batch))
+            if self.next is not None:
+                self.next.offer(forwarded)
+
+    def put(self, item: PipelineItem):
+        """Queue an item, or raise AdmissionRejected if the queue is full"""
+        item.enqueued_at = time.monotonic()
+        try:
+            self.queue.put_nowait(item)
+        except asyncio.QueueFull:
+            self.stats["dropped"] += 1
+            raise AdmissionRejected(f"Ingest stage '{self.name}' is full", Pipeline.retry_after_s())
+
+    def offer(self, items: List[PipelineItem]):
+        """Hand items over from the previous stage. Stages after persist run once
+        the reading is acknowledged, so a slow one drops work instead of stalling ingest."""
+        for item in items:
+            item.enqueued_at = time.monotonic()
+            try:
+                self.queue.put_nowait(item)
+            except asyncio.QueueFull:
+                self.stats["dropped"] += 1
+                if item.future is not None and not item.future.done():
+                    item.future.set_exception(AdmissionRejected(f"Ingest stage '{self.name}' is full", Pipeline.retry_after_s()))
+
+    def busy_rate(self) -> Optional[float]:
+        """Items per second the stage handles with every worker busy, from its
+        measured batch service times; None until it has handled a batch"""
+        if not self.service.total_ms:
+            return None
+        return self.stats["processed"] / (self.service.total_ms / 1000) * self.workers
+
+    def snapshot(self) -> dict:
+        return {
+            "queued": self.queue.qsize() if self.queue is not None else 0,
+            "capacity": self.queue_size,
+            "per_second": self.rate.per_second(),
+            "mean_batch": round(self.stats["processed"] / self.stats["batches"], 2) if self.stats["batches"] else None,
+            **self.stats,
+            "wait": self.wait.snapshot(),
+            "service": self.service.snapshot(),
+        }
+
+
+class Pipeline:
+    """Staged ingest of live sensor readings:
+    decode -> enrich -> persist -> detect -> publish.
+
+    Decoding (parsing and validating the payload) happens in the ingest path
+    that received it and is only timed here. The other stages run on their own
+    workers, connected by bounded queues. A reading is acknowledged once the
+    persist stage has stored it; detect and publish run after that, so work
+    added there does not lengthen request latency. Detectors and publishers
+    are registered with add_detector()/add_publisher(), at import time, and
+    get the stored documents of each batch. A stage without any is left out
+    of the chain."""
+    _stages: Dict[str, Stage] = {}
+    _loop_id: Optional[int] = None
+    decode = Histogram()
+    _decode_rate = RateMeter()
+    _detectors: List[Callable[[List[dict]], Awaitable[None]]] = []
+    _publishers: List[Callable[[List[dict]], Awaitable[None]]] = []
+
+    @classmethod
+    def add_detector(cls, detector: Callable[[List[dict]], Awaitable[None]]):
+        cls._detectors.append(detector)
+
+    @classmethod
+    def add_publisher(cls, publisher: Callable[[List[dict]], Awaitable[None]]):
+        cls._publishers.append(publisher)
+
+    @classmethod
+    def observe_decode(cls, seconds: float):
+        cls.decode.observe(seconds)
+        cls._decode_rate.add(1)
+
+    @classmethod
+    def _ensure_started(cls):
+        """Start the stage workers, again if the event loop changed (serverless invocations)"""
+        loop_id = id(asyncio.get_running_loop())
+        if cls._loop_id == loop_id:
+            return
+        for stage in cls._stages.values():
+            stage.stop()
+        queue_size = int(os.getenv("INGEST_PIPELINE_QUEUE", "1024"))
+        batch_size = int(os.getenv("INGEST_PIPELINE_BATCH", "500"))
+        stages = [
+            Stage("enrich", cls._enrich, queue_size, batch_size),
+            Stage("persist", cls._persist, queue_size, batch_size, workers=PERSIST_WORKERS),
+        ]
+        if cls._detectors:
+            stages.append(Stage("detect", cls._detect, queue_size, batch_size))
+        if cls._publishers:
+            stages.append(Stage("publish", cls._publish, queue_size, batch_size))
+        for stage, next_stage in zip(stages, stages[1:]):
+            stage.next = next_stage
+        for stage in stages:
+            stage.start()
+        cls._stages = {stage.name: stage for stage in stages}
+        cls._loop_id = loop_id
+
+    @classmethod
+    def enqueue(cls, readings: List[SensorDataInput], received_at: Optional[datetime] = None) -> List[asyncio.Future]:
+        """Queue live readings. Returns one future per reading, resolved with its
+        stored id (None for a duplicate). Raises AdmissionRejected if the queue
+        is full; readings of the call queued before that are failed with it."""
+        cls._ensure_started()
+        loop = asyncio.get_running_loop()
+        received_at = received_at or datetime.utcnow()
+        items = [PipelineItem(reading, received_at, future=loop.create_future()) for reading in readings]
+        for index, item in enumerate(items):
+            try:
+                cls._stages["enrich"].put(item)
+            except AdmissionRejected as e:
+                for queued in items[:index]:
+                    queued.future.set_exception(e)
+                    # Retrieved here, so an unawaited failure is not reported as never retrieved
+                    queued.future.exception()
+                raise
+        return [item.future for item in items]
+
+    @classmethod
+    def retry_after_s(cls) -> int:
+        """Time for the readings queued ahead of persisting to be written, at the
+        rate the persist stage has been measured to write them"""
+        backlog = sum(cls._stages[name].queue.qsize() for name in ("enrich", "persist") if name in cls._stages)
+        rate = cls._stages["persist"].busy_rate() if "persist" in cls._stages else None
+        if not rate:
+            return MIN_RETRY_AFTER_S if not backlog else MAX_RETRY_AFTER_S
+        return min(MAX_RETRY_AFTER_S, max(MIN_RETRY_AFTER_S, math.ceil(backlog / rate)))
+
+    @classmethod
+    async def submit(cls, readings: List[SensorDataInput], received_at: Optional[datetime] = None) -> List[Optional[str]]:
+        """Queue live readings and wait until they are stored"""
+        return list(await asyncio.gather(*cls.enqueue(readings, received_at)))
+
+    @staticmethod
+    async def _enrich(items: List[PipelineItem]) -> List[PipelineItem]:
+        fresh = []
+        for item in items:
+            seq = item.reading.seq
+            if seq is not None and SequenceWindows.seen(item.reading.device_id, seq):
+                # A resend after a lost ack: its device time pairs with a later
+                # arrival, so keep it out of the clock estimate as well as the store
+                if not item.future.done():
+                    item.future.set_result(None)
+                continue
+            item.document = MongoDB.build_live_document(item.reading, item.received_at)
+            fresh.append(item)
+        return fresh
+
+    @staticmethod
+    async def _persist(items: List[PipelineItem]) -> List[PipelineItem]:
+        try:
+            async with Admission.write_slot():
+                ids = await MongoDB.write_sensor_documents([item.document for item in items])
+        except Exception as e:
+            for item in items:
+                if not item.future.done():
+                    item.future.set_exception(e)
+            raise
+        stored = []
+        for item, record_id in zip(items, ids):
+            if not item.future.done():
+                item.future.set_result(record_id)
+            if record_id is not None:
+                stored.append(item)
+        return stored
+
+    @classmethod
+    async def _detect(cls, items: List[PipelineItem]) -> List[PipelineItem]:
+        documents = [item.document for item in items]
+        for detector in cls._detectors:
+            await detector(documents)
+        return items
+
+    @classmethod
+    async def _publish(cls, items: List[PipelineItem]) -> List[PipelineItem]:
+        documents = [item.document for item in items]
+        for publisher in cls._publishers:
+            await publisher(documents)
+        return []
+
+    @classmethod
+    async def drain(cls, timeout_s: float = 5.0):
+        """Wait for queued readings to pass through, then stop the workers"""
+        deadline = time.monotonic() + timeout_s
+        while any(stage.active or (stage.queue is not None and not stage.queue.empty()) for stage in cls._stages.values()):
+            if time.monotonic() > deadline:
+                break
+            await asyncio.sleep(0.05)
+        for stage in cls._stages.values():
+            stage.stop()
+        cls._loop_id = None
+
+    @classmethod
+    def get_stats(cls) -> dict:
+        return {
+            "retry_after_s": cls.retry_after_s(),
+            "decode": {"per_second": cls._decode_rate.per_second(), "service": cls.decode.snapshot()},
+            **{name: stage.snapshot() for name, stage in cls._stages.items()},
+        }
+
+
+async def _touch_devices(documents: List[dict]):
+    for device_id in {document["device_id"] for document in documents}:
+        await DeviceRegistry.touch(device_id)
+
+
+Pipeline.add_publisher(_touch_devices)
@@ -0,0 +1,247 @@
+import asyncio
+import hashlib
+import hmac
+import logging
+import os
+import struct
+import time
+from datetime import datetime, timezone
+from typing import Optional, Set, Tuple
+from pydantic import ValidationError
+from app.models.registry import (
+    SENSOR_FIELDS, SCALAR_FLOAT, SCALAR_INT, VECTOR3, SOUND_SPECTRUM, QUATERNION,
+    OCTAVE_BAND_CENTERS_HZ,
+)
+from app.models.sensor import SensorDataInput
+from app.services.admission import Admission, AdmissionRejected
+from app.services.pipeline import Pipeline
+
+logger = logging.getLogger(__name__)
+
+FRAME_VERSION = 1
+FRAME_READING = 0x01
+FRAME_ACK = 0x81
+ACK_STORED = 0
+ACK_BUSY = 1
+TAG_BYTES = 8
+
+# version, type, device id length; then the device id, then seq, device time in ms (0 if unsynced) and field mask
+FRAME_PREFIX = struct.Struct("<BBB")
+FRAME_HEADER = struct.Struct("<QqH")
+# Device times from 2100 on are garbage, and far enough ones overflow datetime
+MAX_TIME_MS = 4102444800000
+# version, type, seq, status, retry after in seconds
+ACK_BODY = struct.Struct("<BBQBH")
+
+_BANDS = len(OCTAVE_BAND_CENTERS_HZ)
+# Encoding of each registry kind; fields are packed in SENSOR_FIELDS order
+VALUE_FORMATS = {
+    SCALAR_FLOAT: struct.Struct("<f"),
+    SCALAR_INT: struct.Struct("<I"),
+    VECTOR3: struct.Struct("<3f"),
+    QUATERNION: struct.Struct("<4f"),
+    SOUND_SPECTRUM: struct.Struct(f"<{_BANDS}fffH"),
+}
+
+
+class FrameError(ValueError):
+    pass
+
+
+def device_key(secret: bytes, device_id: str) -> bytes:
+    """Per-device HMAC key, derived so a leaked board key only exposes that board"""
+    return hmac.new(secret, device_id.encode(), hashlib.sha256).digest()
+
+
+def _tag(key: bytes, body: bytes) -> bytes:
+    return hmac.new(key, body, hashlib.sha256).digest()[:TAG_BYTES]
+
+
+def _unpack_value(kind: str, values: tuple):
+    if kind == VECTOR3:
+        return dict(zip("xyz", values))
+    if kind == QUATERNION:
+        return dict(zip("wxyz", values))
+    if kind == SOUND_SPECTRUM:
+        return {
+            "band_levels_db": list(values[:_BANDS]),
+            "laeq_db": values[_BANDS],
+            "peak_db": values[_BANDS + 1],
+            "peak_events": values[_BANDS + 2],
+        }
+    return values[0]
+
+
+def _pack_value(kind: str, value) -> bytes:
+    if kind == VECTOR3:
+        values = (value["x"], value["y"], value["z"])
+    elif kind == QUATERNION:
+        values = (value["w"], value["x"], value["y"], value["z"])
+    elif kind == SOUND_SPECTRUM:
+        values = (*value["band_levels_db"], value["laeq_db"], value["peak_db"], value["peak_events"])
+    else:
+        values = (value,)
+    return VALUE_FORMATS[kind].pack(*values)
+
+
+def encode_reading(secret: bytes, device_id: str, seq: int, fields: dict, device_time: Optional[datetime] = None) -> bytes:
+    """Build a reading frame as the firmware does; used by simulators and for testing"""
+    device_id_bytes = device_id.encode()
+    mask = 0
+    values = b""
+    for bit, field in enumerate(SENSOR_FIELDS):
+        if fields.get(field.name) is not None:
+            mask |= 1 << bit
+            values += _pack_value(field.kind, fields[field.name])
+    time_ms = round(device_time.timestamp() * 1000) if device_time is not None else 0
+    body = (
+        FRAME_PREFIX.pack(FRAME_VERSION, FRAME_READING, len(device_id_bytes)) + device_id_bytes
+        + FRAME_HEADER.pack(seq, time_ms, mask) + values
+    )
+    return body + _tag(device_key(secret, device_id), body)
+
+
+def decode_reading(secret: bytes, frame: bytes) -> Tuple[SensorDataInput, bytes]:
+    """Authenticate and decode a reading frame. Returns the reading and the device key for the ack."""
+    if len(frame) < FRAME_PREFIX.size + FRAME_HEADER.size + TAG_BYTES:
+        raise FrameError("Frame too short")
+    version, frame_type, id_length = FRAME_PREFIX.unpack_from(frame)
+    if version != FRAME_VERSION or frame_type != FRAME_READING:
+        raise FrameError(f"Unsupported frame version {version} type {frame_type}")
+    offset = FRAME_PREFIX.size + id_length
+    body, tag = frame[:-TAG_BYTES], frame[-TAG_BYTES:]
+    if len(body) < offset + FRAME_HEADER.size:
+        raise FrameError("Frame too short")
+    try:
+        device_id = frame[FRAME_PREFIX.size:offset].decode()
+    except UnicodeDecodeError:
+        raise FrameError("Device id is not UTF-8")
+    key = device_key(secret, device_id)
+    if not hmac.compare_digest(_tag(key, body), tag):
+        raise FrameError("Bad authentication tag")
+
+    seq, time_ms, mask = FRAME_HEADER.unpack_from(body, offset)
+    offset += FRAME_HEADER.size
+    fields = {}
+    for bit, field in enumerate(SENSOR_FIELDS):
+        if mask & (1 << bit):
+            value_format = VALUE_FORMATS[field.kind]
+            if len(body) < offset + value_format.size:
+                raise FrameError("Frame too short for its field mask")
+            fields[field.name] = _unpack_value(field.kind, value_format.unpack_from(body, offset))
+            offset += value_format.size
+    if offset != len(body) or mask >> len(SENSOR_FIELDS):
+        raise FrameError("Frame does not match its field mask")
+
+    if not 0 <= time_ms < MAX_TIME_MS:
+        raise FrameError(f"Device time {time_ms} ms is out of range")
+    timestamp = datetime.fromtimestamp(time_ms / 1000, tz=timezone.utc) if time_ms else None
+    try:
+        reading = SensorDataInput(device_id=device_id, seq=seq, timestamp=timestamp, **fields)
+    except ValidationError as e:
+        raise FrameError(f"Invalid reading: {e.error_count()} errors")
+    return reading, key
+
+
+def encode_ack(key: bytes, seq: int, status: int, retry_after_s: int = 0) -> bytes:
+    body = ACK_BODY.pack(FRAME_VERSION, FRAME_ACK, seq, status, retry_after_s)
+    return body + _tag(key, body)
+
+
+class _IngestProtocol(asyncio.DatagramProtocol):
+    def connection_made(self, transport):
+        UdpIngest._transport = transport
+
+    def datagram_received(self, data: bytes, addr):
+        UdpIngest.receive(data, addr)
+
+    def error_received(self, exc: Exception):
+        logger.warning(f"UDP ingest socket error: {str(exc)}")
+
+
+class UdpIngest:
+    """Datagram listener for compact, HMAC-authenticated reading frames.
+
+    One reading per datagram, acknowledged once stored. Readings are validated
+    against the same model as send_data and handed to the ingest pipeline,
+    whose persist stage writes the readings of the whole fleet in batches."""
+    _transport: Optional[asyncio.DatagramTransport] = None
+    _secret: Optional[bytes] = None
+    # Readings handed to the pipeline and not acknowledged yet
+    _in_flight: Set[asyncio.Task] = set()
+    _stats = {"received": 0, "stored": 0, "duplicates": 0, "rejected_invalid": 0, "rejected_busy": 0, "failed": 0}
+
+    @staticmethod
+    def enabled() -> bool:
+        return bool(os.getenv("UDP_INGEST_PORT"))
+
+    @classmethod
+    async def start(cls):
+        secret = os.getenv("UDP_INGEST_SECRET")
+        if not secret:
+            raise ValueError("UDP_INGEST_SECRET must be set when UDP_INGEST_PORT is")
+        cls._secret = secret.encode()
+        host = os.getenv("UDP_INGEST_HOST", "0.0.0.0")
+        port = int(os.getenv("UDP_INGEST_PORT"))
+        await asyncio.get_running_loop().create_datagram_endpoint(_IngestProtocol, local_addr=(host, port))
+        logger.info(f"UDP ingest listening on {host}:{port}")
+
+    @classmethod
+    async def stop(cls):
+        if cls._in_flight:
+            # Let readings already received be stored, acks are dropped once the socket closes
+            await asyncio.wait(cls._in_flight, timeout=5)
+        if cls._transport is not None:
+            cls._transport.close()
+            cls._transport = None
+
+    @classmethod
+    def receive(cls, data: bytes, addr):
+        cls._stats["received"] += 1
+        received_at = datetime.utcnow()
+        started = time.perf_counter()
+        try:
+            reading, key = decode_reading(cls._secret, data)
+        except FrameError as e:
+            # Never answer a frame that failed authentication or decoding
+            cls._stats["rejected_invalid"] += 1
+            logger.debug(f"Dropped UDP frame from {addr}: {str(e)}")
+            return
+        Pipeline.observe_decode(time.perf_counter() - started)
+
+        try:
+            Admission.check_rate(reading.device_id)
+        except AdmissionRejected as e:
+            cls._stats["rejected_busy"] += 1
+            cls._send(encode_ack(key, reading.seq, ACK_BUSY, e.retry_after_s), addr)
+            return
+        task = asyncio.create_task(cls._store(reading, received_at, key, addr))
+        cls._in_flight.add(task)
+        task.add_done_callback(cls._in_flight.discard)
+
+    @classmethod
+    async def _store(cls, reading: SensorDataInput, received_at: datetime, key: bytes, addr):
+        try:
+            record_id, = await Pipeline.submit([reading], received_at)
+        except AdmissionRejected as e:
+            cls._stats["rejected_busy"] += 1
+            cls._send(encode_ack(key, reading.seq, ACK_BUSY, e.retry_after_s), addr)
+            return
+        except Exception:
+            # No ack, so the board resends; the pipeline has logged the error
+            cls._stats["failed"] += 1
+            return
+        cls._stats["stored" if record_id is not None else "duplicates"] += 1
+        # A duplicate is acknowledged like a stored reading: the board must stop resending it
+        cls._send(encode_ack(key, reading.seq, ACK_STORED), addr)
+
+    @classmethod
+    def _send(cls, ack: bytes, addr):
+        if cls._transport is not None:
+            cls._transport.sendto(ack, addr)
+
+    @classmethod
+    def get_stats(cls) -> dict:
+        if not cls.enabled():
+            return {"enabled": False}
+        return {"enabled": True, "in_flight": len(cls._in_flight), **cls._stats}
@@ -0,0 +1,357 @@
+import asyncio
+import json
+import logging
+import os
+import struct
+import time
+import zlib
+from concurrent.futures import ThreadPoolExecutor
+from datetime import datetime
+from typing import Awaitable, Callable, List, Optional, Tuple
+from bson import ObjectId
+from pymongo.errors import ConnectionFailure
+
+logger = logging.getLogger(__name__)
+
+WAL_MODE_OFF = "off"
+# Write to MongoDB, and to the log only if the write fails
+WAL_MODE_FALLBACK = "fallback"
+# Acknowledge once the reading is in the log; the replayer writes it to MongoDB
+WAL_MODE_ALWAYS = "always"
+
+# Frame header: payload length and CRC32 of the payload, little endian
+FRAME_HEADER = struct.Struct("<II")
+SEGMENT_PREFIX = "wal-"
+SEGMENT_SUFFIX = ".log"
+CHECKPOINT_FILE = "checkpoint.json"
+# Records MongoDB rejected for a reason other than being unreachable, framed like a segment
+REJECTED_FILE = "rejected.log"
+
+# Records handed to the store per replay round trip
+REPLAY_BATCH_SIZE = 500
+# Replayer poll interval while the log is drained, and the backoff bounds after a failed store
+REPLAY_IDLE_S = 1.0
+REPLAY_MAX_BACKOFF_S = 30.0
+
+# (segment id, byte offset) of the next record to replay
+Position = Tuple[int, int]
+
+
+def _encode(value):
+    if isinstance(value, datetime):
+        return {"$date": value.isoformat()}
+    if isinstance(value, ObjectId):
+        return {"$oid": str(value)}
+    raise TypeError(f"Cannot encode {type(value).__name__}")
+
+
+def _decode(value: dict):
+    if len(value) == 1:
+        if "$date" in value:
+            return datetime.fromisoformat(value["$date"])
+        if "$oid" in value:
+            return ObjectId(value["$oid"])
+    return value
+
+
+class WriteAheadLog:
+    """Segmented append-only log of CRC-framed records.
+
+    Records are appended to the active segment, which is rolled once it grows
+    past segment_bytes. Every batch is fsynced before it is acknowledged. The
+    checkpoint file records how far the log has been replayed; segments wholly
+    before it are deleted. Not thread safe: IngestLog runs every call on one
+    worker thread."""
+
+    def __init__(self, directory: str, segment_bytes: int):
+        self.directory = directory
+        self.segment_bytes = segment_bytes
+        os.makedirs(directory, exist_ok=True)
+        existing = self._segment_ids()
+        # Always start a fresh segment; the last one may end in a torn frame from a crash
+        self.active_id = (existing[-1] if existing else 0) + 1
+        self._file = open(self._path(self.active_id), "ab")
+        self.position = self._load_checkpoint(existing[0] if existing else self.active_id)
+
+    def _path(self, segment_id: int) -> str:
+        return os.path.join(self.directory, f"{SEGMENT_PREFIX}{segment_id:010d}{SEGMENT_SUFFIX}")
+
+    def _segment_ids(self) -> List[int]:
+        return sorted(
+            int(name[len(SEGMENT_PREFIX):-len(SEGMENT_SUFFIX)])
+            for name in os.listdir(self.directory)
+            if name.startswith(SEGMENT_PREFIX) and name.endswith(SEGMENT_SUFFIX)
+        )
+
+    def _load_checkpoint(self, first_segment_id: int) -> Position:
+        try:
+            with open(os.path.join(self.directory, CHECKPOINT_FILE)) as f:
+                checkpoint = json.load(f)
+            return max((checkpoint["segment"], checkpoint["offset"]), (first_segment_id, 0))
+        except FileNotFoundError:
+            return (first_segment_id, 0)
+
+    @staticmethod
+    def _frames(payloads: List[bytes]) -> bytes:
+        return b"".join(FRAME_HEADER.pack(len(payload), zlib.crc32(payload)) + payload for payload in payloads)
+
+    def append(self, payloads: List[bytes]):
+        """Write and fsync a batch of records"""
+        self._file.write(self._frames(payloads))
+        self._file.flush()
+        os.fsync(self._file.fileno())
+        if self._file.tell() >= self.segment_bytes:
+            self._file.close()
+            self.active_id += 1
+            self._file = open(self._path(self.active_id), "ab")
+
+    def read(self, max_records: int) -> Tuple[List[bytes], Position]:
+        """Read up to max_records from the checkpoint on. Returns the records and
+        the position after them, to be passed to commit() once they are stored."""
+        segment_id, offset = self.position
+        records = []
+        while len(records) < max_records and segment_id <= self.active_id:
+            path = self._path(segment_id)
+            if not os.path.exists(path):
+                segment_id, offset = segment_id + 1, 0
+                continue
+            with open(path, "rb") as f:
+                f.seek(offset)
+                while len(records) < max_records:
+                    header = f.read(FRAME_HEADER.size)
+                    if len(header) < FRAME_HEADER.size:
+                        break
+                    length, crc = FRAME_HEADER.unpack(header)
+                    payload = f.read(length)
+                    if not length or len(payload) < length or zlib.crc32(payload) != crc:
+                        offset = self._resync(f, segment_id, offset)
+                        f.seek(offset)
+                        continue
+                    records.append(payload)
+                    offset += FRAME_HEADER.size + length
+            if len(records) >= max_records or segment_id == self.active_id:
+                break
+            segment_id, offset = segment_id + 1, 0
+        return records, (segment_id, offset)
+
+    @staticmethod
+    def _resync(f, segment_id: int, offset: int) -> int:
+        """Offset of the next valid frame after a corrupt one at `offset`, or of
+        the end of the segment if there is none. A crash can leave a torn frame
+        at the end of a segment; anything else is damage to the file."""
+        f.seek(offset + 1)
+        data = f.read()
+        for start in range(len(data) - FRAME_HEADER.size + 1):
+            length, crc = FRAME_HEADER.unpack_from(data, start)
+            end = start + FRAME_HEADER.size + length
+            if length and end <= len(data) and zlib.crc32(data[start + FRAME_HEADER.size:end]) == crc:
+                logger.warning(f"Skipped {start + 1} corrupt bytes in WAL segment {segment_id} at offset {offset}")
+                return offset + 1 + start
+        logger.warning(f"Discarding corrupt tail of WAL segment {segment_id} at offset {offset}")
+        return offset + 1 + len(data)
+
+    def commit(self, position: Position):
+        """Persist the replay position and delete segments that are fully replayed"""
+        path = os.path.join(self.directory, CHECKPOINT_FILE)
+        with open(path + ".tmp", "w") as f:
+            json.dump({"segment": position[0], "offset": position[1]}, f)
+            f.flush()
+            os.fsync(f.fileno())
+        os.replace(path + ".tmp", path)
+        self.position = position
+        for segment_id in self._segment_ids():
+            if segment_id < position[0]:
+                os.remove(self._path(segment_id))
+
+    def set_aside(self, payloads: List[bytes]):
+        """Append records that can never be stored to the rejected file, so
+        replay can move past them without losing them"""
+        with open(os.path.join(self.directory, REJECTED_FILE), "ab") as f:
+            f.write(self._frames(payloads))
+            f.flush()
+            os.fsync(f.fileno())
+
+    def pending_bytes(self) -> int:
+        """Unreplayed bytes. Safe to call from another thread than the one
+        running commit(); segments it deletes meanwhile are skipped."""
+        segment, offset = self.position
+        total = 0
+        for segment_id in self._segment_ids():
+            if segment_id >= segment:
+                try:
+                    total += os.path.getsize(self._path(segment_id))
+                except FileNotFoundError:
+                    pass
+        return max(total - offset, 0)
+
+    def close(self):
+        self._file.close()
+
+
+class IngestLog:
+    """Write-ahead log for sensor reading documents, kept when WAL_DIR is set.
+
+    Appends are group-committed: requests that arrive while a batch is being
+    written and fsynced are written together in the next batch, so the fsync
+    cost is shared. A background replayer drains the log into MongoDB in bulk."""
+    mode: Optional[str] = None
+    _wal: Optional[WriteAheadLog] = None
+    # One thread for all file I/O keeps appends, reads and commits ordered
+    _executor: Optional[ThreadPoolExecutor] = None
+    _pending: List[Tuple[bytes, asyncio.Future]] = []
+    _flush_task: Optional[asyncio.Task] = None
+    # Set by a failed MongoDB write, cleared once the replayer stores a batch
+    _bypassing = False
+    _oldest_pending_at: Optional[float] = None
+    _stats = {"appended": 0, "replayed": 0, "rejected": 0, "fsyncs": 0}
+    _last_error: Optional[str] = None
+
+    @classmethod
+    def _configure(cls):
+        # Read lazily so values from .env (loaded after imports) apply
+        if cls.mode is not None:
+            return
+        directory = os.getenv("WAL_DIR")
+        mode = os.getenv("WAL_MODE", WAL_MODE_FALLBACK) if directory else WAL_MODE_OFF
+        if mode not in (WAL_MODE_OFF, WAL_MODE_FALLBACK, WAL_MODE_ALWAYS):
+            raise ValueError(f"WAL_MODE must be '{WAL_MODE_FALLBACK}' or '{WAL_MODE_ALWAYS}'")
+        if mode != WAL_MODE_OFF:
+            cls._wal = WriteAheadLog(directory, int(os.getenv("WAL_SEGMENT_BYTES", str(16 * 1024 * 1024))))
+            cls._executor = ThreadPoolExecutor(max_workers=1, thread_name_prefix="wal")
+            logger.info(f"Write-ahead log enabled in '{directory}' ({mode} mode)")
+        cls.mode = mode
+
+    @classmethod
+    def enabled(cls) -> bool:
+        cls._configure()
+        return cls.mode != WAL_MODE_OFF
+
+    @classmethod
+    def writes_ahead(cls) -> bool:
+        """True if readings should go to the log instead of MongoDB right now"""
+        cls._configure()
+        return cls.mode == WAL_MODE_ALWAYS or (cls.mode == WAL_MODE_FALLBACK and cls._bypassing)
+
+    @classmethod
+    def record_store_failure(cls, error: Exception):
+        """Send readings straight to the log until the replayer reaches MongoDB
+        again, instead of making each request wait for a write to fail"""
+        cls._bypassing = True
+        cls._last_error = str(error)
+
+    @staticmethod
+    def assign_ids(documents: List[dict]):
+        """Give documents their final _id before the first write attempt, so a
+        replay of a reading MongoDB did store is rejected as a duplicate key"""
+        for document in documents:
+            document.setdefault("_id", ObjectId())
+
+    @classmethod
+    async def _run(cls, function, *args):
+        return await asyncio.get_running_loop().run_in_executor(cls._executor, function, *args)
+
+    @classmethod
+    async def append(cls, documents: List[dict]):
+        """Durably append reading documents; returns once they are fsynced"""
+        cls.assign_ids(documents)
+        loop = asyncio.get_running_loop()
+        futures = []
+        for document in documents:
+            payload = json.dumps({"t": time.time(), "d": document}, default=_encode, separators=(",", ":")).encode()
+            future = loop.create_future()
+            cls._pending.append((payload, future))
+            futures.append(future)
+        if cls._flush_task is None or cls._flush_task.done():
+            cls._flush_task = asyncio.create_task(cls._flush())
+        await asyncio.gather(*futures)
+
+    @classmethod
+    async def _flush(cls):
+        while cls._pending:
+            batch, cls._pending = cls._pending, []
+            try:
+                await cls._run(cls._wal.append, [payload for payload, _ in batch])
+            except Exception as e:
+                logger.error(f"WAL append failed: {str(e)}", exc_info=True)
+                for _, future in batch:
+                    future.set_exception(e)
+                continue
+            cls._stats["appended"] += len(batch)
+            cls._stats["fsyncs"] += 1
+            for _, future in batch:
+                future.set_result(None)
+
+    @classmethod
+    async def run_replayer(cls, store: Callable[[List[dict]], Awaitable[List[Optional[str]]]]):
+        """Drain the log into `store` forever, backing off while it fails"""
+        backoff_s = REPLAY_IDLE_S
+        while True:
+            records, position = await cls._run(cls._wal.read, REPLAY_BATCH_SIZE)
+            if not records:
+                cls._oldest_pending_at = None
+                if position != cls._wal.position:
+                    # Skipped a missing segment or a corrupt tail
+                    await cls._run(cls._wal.commit, position)
+                await asyncio.sleep(REPLAY_IDLE_S)
+                continue
+
+            entries = [json.loads(record, object_hook=_decode) for record in records]
+            cls._oldest_pending_at = entries[0]["t"]
+            try:
+                await cls._replay(store, records, entries)
+            except ConnectionFailure as e:
+                cls.record_store_failure(e)
+                logger.warning(f"WAL replay failed, retrying in {backoff_s:.0f}s: {str(e)}")
+                await asyncio.sleep(backoff_s)
+                backoff_s = min(backoff_s * 2, REPLAY_MAX_BACKOFF_S)
+                continue
+            backoff_s = REPLAY_IDLE_S
+            cls._bypassing = False
+            await cls._run(cls._wal.commit, position)
+            cls._stats["replayed"] += len(entries)
+
+    @classmethod
+    async def _replay(cls, store: Callable[[List[dict]], Awaitable[List[Optional[str]]]], records: List[bytes], entries: List[dict]):
+        """Store a batch of log entries. Only an unreachable MongoDB is retried
+        (ConnectionFailure propagates). If MongoDB rejects the batch for any
+        other reason, the entries are stored one at a time and those it still
+        rejects are set aside, so one bad record cannot block the log."""
+        try:
+            await store([entry["d"] for entry in entries])
+            return
+        except ConnectionFailure:
+            raise
+        except Exception as e:
+            logger.warning(f"WAL replay batch rejected, storing its {len(entries)} records one at a time: {str(e)}")
+        rejected = []
+        for record, entry in zip(records, entries):
+            try:
+                await store([entry["d"]])
+            except ConnectionFailure:
+                raise
+            except Exception as e:
+                logger.error(f"MongoDB rejected a WAL record, moving it to {REJECTED_FILE}: {str(e)}")
+                cls._last_error = str(e)
+                rejected.append(record)
+        if rejected:
+            await cls._run(cls._wal.set_aside, rejected)
+            cls._stats["rejected"] += len(rejected)
+
+    @classmethod
+    async def close(cls):
+        if cls._wal is not None:
+            await cls._run(cls._wal.close)
+
+    @classmethod
+    def get_stats(cls) -> dict:
+        cls._configure()
+        if cls.mode == WAL_MODE_OFF:
+            return {"mode": WAL_MODE_OFF}
+        return {
+            "mode": cls.mode,
+            "pending_bytes": cls._wal.pending_bytes(),
+            "replay_lag_s": round(time.time() - cls._oldest_pending_at, 3) if cls._oldest_pending_at else 0.0,
+            "bypassing_mongodb": cls._bypassing,
+            "last_error": cls._last_error,
+            **cls._stats,
+        }
@@ -0,0 +1,169 @@
+"""
+Ingest throughput benchmark for POST /api/send_data.
+
+Two measurements, each reported as requests per second on one core:
+
+    decode  In process, no server or database: turn a request body into the
+            document that is stored, once the way send_data used to (the
+            body decoded as request.json() does, then SensorDataInput(**body),
+            then a model_dump that includes every sensor field by name) and
+            once the way it does now (the raw bytes validated in one pass, then
+            a model_dump that excludes the metadata fields).
+    http    Against a running single-process server, with a number of
+            keep-alive connections posting readings in a loop, each as its
+            own device. A connection posts far faster than the per-device
+            rate limit allows, so start the server with the limit raised as
+            below. Only 200 responses count towards requests_per_s; 429s are
+            reported separately. Run it once on the old code and once on the
+            new code to compare.
+
+Usage (from apps/backend):
+    uv run python scripts/bench_ingest.py decode
+    INGEST_DEVICE_RATE=1000000 INGEST_DEVICE_BURST=1000000 uv run python -m app &
+    uv run python scripts/bench_ingest.py http --port 8000 --seconds 10
+"""
+import argparse
+import asyncio
+import json
+import sys
+import time
+from pathlib import Path
+
+BACKEND_DIR = Path(__file__).resolve().parent.parent
+sys.path.insert(0, str(BACKEND_DIR))
+
+SAMPLE_READING = {
+    "temperature": 22.5,
+    "humidity": 50.0,
+    "voc": 150,
+    "light": 2048,
+    "sound": 1024,
+    "accelerometer": {"x": 0.1, "y": 0.2, "z": 9.8},
+    "gyroscope": {"x": 0.01, "y": 0.02, "z": 0.03},
+}
+
+
+def _reading_body(seq: int, device_id: str = "bench-board") -> bytes:
+    return json.dumps({"device_id": device_id, **SAMPLE_READING, "seq": seq}, separators=(",", ":")).encode()
+
+
+def _rate(function, bodies) -> float:
+    started = time.perf_counter()
+    for body in bodies:
+        function(body)
+    return len(bodies) / (time.perf_counter() - started)
+
+
+def run_decode(args) -> dict:
+    from datetime import datetime
+    from app.database.mongodb import MongoDB
+    from app.models.registry import SENSOR_FIELD_NAMES
+    from app.models.sensor import DEFAULT_DEVICE_ID, SensorDataInput
+    from app.services.clock_sync import ClockSync, to_naive_utc
+
+    def before_change(body: bytes):
+        # send_data and MongoDB.build_live_document as they were before the
+        # raw-bytes path, kept here so the baseline does not drift with the app
+        data = SensorDataInput(**json.loads(body))
+        received_at = datetime.utcnow()
+        timestamp = ClockSync.stamp(data.device_id, data.timestamp, received_at)
+        document = {"timestamp": timestamp, **data.model_dump(include=SENSOR_FIELD_NAMES, exclude_none=True)}
+        document["received_at"] = received_at
+        if data.timestamp is not None:
+            document["device_timestamp"] = to_naive_utc(data.timestamp)
+        document["device_id"] = data.device_id or DEFAULT_DEVICE_ID
+        if data.sample_rates_hz:
+            document["sample_rates_hz"] = data.sample_rates_hz
+        if data.report_interval_s is not None:
+            document["report_interval_s"] = data.report_interval_s
+        if data.seq is not None:
+            document["seq"] = data.seq
+        return document
+
+    def after_change(body: bytes):
+        return MongoDB.build_live_document(SensorDataInput.model_validate_json(body))
+
+    bodies = [_reading_body(seq) for seq in range(args.requests)]
+    # Warm up validators and caches before timing
+    _rate(before_change, bodies[:1000])
+    _rate(after_change, bodies[:1000])
+    before = max(_rate(before_change, bodies) for _ in range(args.rounds))
+    after = max(_rate(after_change, bodies) for _ in range(args.rounds))
+    return {
+        "mode": "decode",
+        "requests": args.requests,
+        "before_per_s": round(before),
+        "after_per_s": round(after),
+        "speedup": round(after / before, 2),
+    }
+
+
+async def _client(host: str, port: int, path: str, deadline: float, device_id: str, stats: dict):
+    reader, writer = await asyncio.open_connection(host, port)
+    seq = 0
+    try:
+        while time.perf_counter() < deadline:
+            body = _reading_body(seq, device_id)
+            seq += 1
+            writer.write(
+                (
+                    f"POST {path} HTTP/1.1\r\n"
+                    f"Host: {host}\r\n"
+                    "Content-Type: application/json\r\n"
+                    f"Content-Length: {len(body)}\r\n"
+                    "\r\n"
+                ).encode() + body
+            )
+            head = await reader.readuntil(b"\r\n\r\n")
+            lines = head.decode("latin-1").split("\r\n")
+            content_length = 0
+            for line in lines[1:]:
+                name, _, value = line.partition(":")
+                if name.strip().lower() == "content-length":
+                    content_length = int(value)
+            await reader.readexactly(content_length)
+            status = lines[0].split(" ")[1]
+            stats["ok" if status == "200" else "rate_limited" if status == "429" else "errors"] += 1
+    finally:
+        writer.close()
+
+
+async def _run_http(args) -> dict:
+    stats = {"ok": 0, "rate_limited": 0, "errors": 0}
+    started = time.perf_counter()
+    deadline = started + args.seconds
+    # Each connection posts as its own device, so seqs never collide and no
+    # connection draws on another's rate limit
+    await asyncio.gather(*(
+        _client(args.host, args.port, args.path, deadline, f"bench-board-{connection}", stats)
+        for connection in range(args.connections)
+    ))
+    elapsed = time.perf_counter() - started
+    return {
+        "mode": "http",
+        "connections": args.connections,
+        **stats,
+        # Only stored readings count; rejections take a much cheaper path
+        "requests_per_s": round(stats["ok"] / elapsed, 1),
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark send_data ingest throughput")
+    subparsers = parser.add_subparsers(dest="mode", required=True)
+    decode = subparsers.add_parser("decode", help="Body to document, in process")
+    decode.add_argument("--requests", type=int, default=20000)
+    decode.add_argument("--rounds", type=int, default=3, help="Timed rounds per variant; the best is reported")
+    http = subparsers.add_parser("http", help="Requests per second against a running server")
+    http.add_argument("--host", default="localhost")
+    http.add_argument("--port", type=int, default=8000)
+    http.add_argument("--path", default="/api/send_data")
+    http.add_argument("--connections", type=int, default=16)
+    http.add_argument("--seconds", type=float, default=10.0)
+    args = parser.parse_args()
+    result = run_decode(args) if args.mode == "decode" else asyncio.run(_run_http(args))
+    print(json.dumps(result, indent=2))
+
+
+if __name__ == "__main__":
+    main()
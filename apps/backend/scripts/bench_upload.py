@@ -0,0 +1,221 @@
+"""
+Host-side upload benchmark that mimics the board's HTTPS client.
+
+Sends sensor readings to POST /api/send_data over TLS and reports how many
+full and resumed handshakes were needed and how many bytes went over the wire
+per upload. Use it to compare connection strategies against a local TLS server:
+
+    SSL_KEYFILE=key.pem SSL_CERTFILE=cert.pem uv run python -m app
+    uv run python scripts/bench_upload.py --port 8000 --insecure --mode fresh
+    uv run python scripts/bench_upload.py --port 8000 --insecure --mode keepalive
+
+The default pace (4 uploads/s) stays under the backend's per-device rate
+limit (INGEST_DEVICE_RATE, 5/s). Uploads answered with 429 are counted in
+rate_limited, not errors.
+
+Modes:
+    fresh      new TCP connection and full TLS handshake per upload
+    resume     new TCP connection per upload, TLS session resumed from a ticket/ID
+    keepalive  one persistent connection, reconnecting with session resumption
+               only when the server drops it
+"""
+import argparse
+import json
+import socket
+import ssl
+import sys
+import time
+from pathlib import Path
+
+BACKEND_DIR = Path(__file__).resolve().parent.parent
+sys.path.insert(0, str(BACKEND_DIR))
+
+from app.models.registry import (  # noqa: E402
+    SENSOR_FIELDS, SCALAR_INT, VECTOR3, SOUND_SPECTRUM, QUATERNION,
+    OCTAVE_BAND_CENTERS_HZ,
+)
+
+
+def _sample_value(field):
+    """A plausible value for a registry field, within its bounds"""
+    if field.kind == VECTOR3:
+        return {"x": 0.1, "y": 0.2, "z": 9.8}
+    if field.kind == QUATERNION:
+        return {"w": 1.0, "x": 0.0, "y": 0.0, "z": 0.0}
+    if field.kind == SOUND_SPECTRUM:
+        return {"band_levels_db": [40.0] * len(OCTAVE_BAND_CENTERS_HZ), "laeq_db": 45.0, "peak_db": 60.0, "peak_events": 0}
+    low = field.ge if field.ge is not None else 0
+    value = (low + field.le) / 2 if field.le is not None else low + 20
+    return int(value) if field.kind == SCALAR_INT else float(value)
+
+
+# A reading with every registered sensor field, as the board sends after a heartbeat
+SAMPLE_READING = {field.name: _sample_value(field) for field in SENSOR_FIELDS}
+
+
+class TlsConnection:
+    """Minimal HTTP/1.1 over TLS client that counts raw bytes on the socket.
+
+    TLS runs over memory BIOs so every handshake and record byte is accounted
+    for, the same way lwIP sees them on the board."""
+
+    def __init__(self, host: str, port: int, context: ssl.SSLContext, session=None):
+        self.host = host
+        self.sock = socket.create_connection((host, port))
+        self.incoming = ssl.MemoryBIO()
+        self.outgoing = ssl.MemoryBIO()
+        self.tls = context.wrap_bio(self.incoming, self.outgoing, server_hostname=host, session=session)
+        self.bytes_sent = 0
+        self.bytes_received = 0
+        self._buffer = b""
+        self._retry(self.tls.do_handshake)
+
+    def _flush(self):
+        data = self.outgoing.read()
+        if data:
+            self.sock.sendall(data)
+            self.bytes_sent += len(data)
+
+    def _fill(self):
+        data = self.sock.recv(16384)
+        if not data:
+            raise ConnectionError("Connection closed by server")
+        self.bytes_received += len(data)
+        self.incoming.write(data)
+
+    def _retry(self, operation, *args):
+        while True:
+            try:
+                result = operation(*args)
+                self._flush()
+                return result
+            except ssl.SSLWantReadError:
+                self._flush()
+                self._fill()
+
+    def _read_more(self):
+        chunk = self._retry(self.tls.read, 16384)
+        if not chunk:
+            raise ConnectionError("Connection closed by server")
+        self._buffer += chunk
+
+    def post(self, path: str, body: bytes, keep_alive: bool) -> tuple[int, bool]:
+        """Send a POST request and return (status code, server keeps connection open)"""
+        request = (
+            f"POST {path} HTTP/1.1\r\n"
+            f"Host: {self.host}\r\n"
+            "Content-Type: application/json\r\n"
+            f"Content-Length: {len(body)}\r\n"
+            f"Connection: {'keep-alive' if keep_alive else 'close'}\r\n"
+            "\r\n"
+        ).encode() + body
+        self._retry(self.tls.write, request)
+
+        while b"\r\n\r\n" not in self._buffer:
+            self._read_more()
+        head, self._buffer = self._buffer.split(b"\r\n\r\n", 1)
+        lines = head.decode("latin-1").split("\r\n")
+        status = int(lines[0].split(" ")[1])
+        headers = {}
+        for line in lines[1:]:
+            name, _, value = line.partition(":")
+            headers[name.strip().lower()] = value.strip()
+
+        content_length = int(headers.get("content-length", "0"))
+        while len(self._buffer) < content_length:
+            self._read_more()
+        self._buffer = self._buffer[content_length:]
+
+        return status, headers.get("connection", "").lower() != "close"
+
+    @property
+    def session_reused(self) -> bool:
+        return self.tls.session_reused
+
+    def close(self):
+        try:
+            self.tls.unwrap()
+            self._flush()
+        except (ssl.SSLError, OSError):
+            pass
+        self.sock.close()
+
+
+def run(args) -> dict:
+    context = ssl.create_default_context()
+    if args.insecure:
+        context.check_hostname = False
+        context.verify_mode = ssl.CERT_NONE
+
+    body = json.dumps(SAMPLE_READING, separators=(",", ":")).encode()
+    keep_alive = args.mode == "keepalive"
+    reuse_session = args.mode in ("resume", "keepalive")
+
+    stats = {"full_handshakes": 0, "resumed_handshakes": 0, "bytes_sent": 0, "bytes_received": 0, "errors": 0, "rate_limited": 0}
+    latencies = []
+    connection = None
+    session = None
+
+    for _ in range(args.uploads):
+        for attempt in range(2):
+            started = time.perf_counter()
+            try:
+                if connection is None:
+                    # Handshake bytes are charged to the upload that needed them
+                    connection = TlsConnection(args.host, args.port, context, session if reuse_session else None)
+                    sent_before = received_before = 0
+                    if connection.session_reused:
+                        stats["resumed_handshakes"] += 1
+                    else:
+                        stats["full_handshakes"] += 1
+                else:
+                    sent_before, received_before = connection.bytes_sent, connection.bytes_received
+                status, server_keeps_open = connection.post(args.path, body, keep_alive)
+                latencies.append(time.perf_counter() - started)
+                stats["bytes_sent"] += connection.bytes_sent - sent_before
+                stats["bytes_received"] += connection.bytes_received - received_before
+                if status == 429:
+                    stats["rate_limited"] += 1
+                elif status != 200:
+                    stats["errors"] += 1
+                session = connection.tls.session
+                if not (keep_alive and server_keeps_open):
+                    connection.close()
+                    connection = None
+                break
+            except (ConnectionError, OSError, ssl.SSLError):
+                # Server dropped an idle keep-alive connection: reconnect once, resuming the session
+                if connection is not None:
+                    connection.close()
+                    connection = None
+                if attempt == 1:
+                    stats["errors"] += 1
+        time.sleep(args.interval)
+
+    if connection is not None:
+        connection.close()
+
+    uploads = max(args.uploads, 1)
+    return {
+        "mode": args.mode,
+        "uploads": args.uploads,
+        **stats,
+        "bytes_per_upload": round((stats["bytes_sent"] + stats["bytes_received"]) / uploads, 1),
+        "avg_latency_ms": round(1000 * sum(latencies) / max(len(latencies), 1), 2),
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark board-style HTTPS uploads")
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=443)
+    parser.add_argument("--path", default="/api/send_data")
+    parser.add_argument("--mode", choices=["fresh", "resume", "keepalive"], default="keepalive")
+    parser.add_argument("--uploads", type=int, default=50)
+    parser.add_argument("--interval", type=float, default=0.25, help="Seconds between uploads (default stays under the per-device rate limit)")
+    parser.add_argument("--insecure", action="store_true", help="Skip certificate verification (self-signed local server)")
+    print(json.dumps(run(parser.parse_args()), indent=2))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,104 @@
+"""
+Generate the frontend sensor types from the backend's SensorDataOutput model,
+whose sensor fields come from the sensor registry.
+
+Usage (from apps/backend):
+    uv run python scripts/generate_sensor_types.py          # rewrite apps/frontend/types/sensor.ts
+    uv run python scripts/generate_sensor_types.py --check  # fail if the file is out of date
+"""
+import argparse
+import sys
+from pathlib import Path
+
+BACKEND_DIR = Path(__file__).resolve().parent.parent
+sys.path.insert(0, str(BACKEND_DIR))
+
+from datetime import datetime  # noqa: E402
+from typing import Dict, List, Union, get_args, get_origin  # noqa: E402
+from pydantic import BaseModel  # noqa: E402
+from app.models.registry import OCTAVE_BAND_CENTERS_HZ, SENSOR_FIELD_NAMES  # noqa: E402
+from app.models.sensor import SensorDataOutput  # noqa: E402
+
+OUTPUT_PATH = BACKEND_DIR.parent / "frontend" / "types" / "sensor.ts"
+
+HEADER = """\
+// Generated by apps/backend/scripts/generate_sensor_types.py from the
+// SensorDataOutput model in apps/backend/app/models/sensor.py, whose sensor
+// fields come from apps/backend/app/models/registry.py. Do not edit by hand.
+"""
+
+# TypeScript type per Python scalar type; datetimes are serialized as ISO 8601 strings
+TS_SCALARS = {str: "string", int: "number", float: "number", bool: "boolean", datetime: "string"}
+
+
+def ts_type(annotation, models: List[type]) -> str:
+    """TypeScript type of a pydantic field annotation, without its null option.
+    Nested models are appended to `models` so their interfaces get emitted."""
+    if get_origin(annotation) is Union:
+        (annotation,) = [arg for arg in get_args(annotation) if arg is not type(None)]
+    if get_origin(annotation) in (list, List):
+        return f"{ts_type(get_args(annotation)[0], models)}[]"
+    if get_origin(annotation) in (dict, Dict):
+        # Keyed by sensor field name, and only fields the board reported are present
+        return f"Partial<Record<string, {ts_type(get_args(annotation)[1], models)}>>"
+    if isinstance(annotation, type) and issubclass(annotation, BaseModel):
+        if annotation not in models:
+            models.append(annotation)
+        return annotation.__name__
+    return TS_SCALARS[annotation]
+
+
+def is_nullable(annotation) -> bool:
+    return get_origin(annotation) is Union and type(None) in get_args(annotation)
+
+
+def render_interface(name: str, model: type, models: List[type]) -> List[str]:
+    lines = [f"export interface {name} {{"]
+    for field_name, field in model.model_fields.items():
+        field_type = ts_type(field.annotation, models)
+        if field.description:
+            lines.append(f"  /** {field.description} */")
+        if field_name in SENSOR_FIELD_NAMES:
+            # null until the board has reported the field at least once (sparse uploads)
+            lines.append(f"  {field_name}: {field_type} | null;")
+        elif field.is_required():
+            lines.append(f"  {field_name}: {field_type};")
+        else:
+            lines.append(f"  {field_name}?: {field_type}{' | null' if is_nullable(field.annotation) else ''};")
+    lines += ["}", ""]
+    return lines
+
+
+def render() -> str:
+    lines = [HEADER]
+    lines.append(f"export const OCTAVE_BAND_CENTERS_HZ = [{', '.join(str(hz) for hz in OCTAVE_BAND_CENTERS_HZ)}] as const;")
+    lines.append("")
+
+    # Rendering SensorData first collects the nested models it refers to
+    models: List[type] = []
+    sensor_data = render_interface("SensorData", SensorDataOutput, models)
+    index = 0
+    while index < len(models):
+        lines += render_interface(models[index].__name__, models[index], models)
+        index += 1
+    lines += sensor_data
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate frontend sensor types")
+    parser.add_argument("--check", action="store_true", help="Exit with an error if the generated file is stale")
+    args = parser.parse_args()
+
+    content = render()
+    if args.check:
+        if not OUTPUT_PATH.exists() or OUTPUT_PATH.read_text() != content:
+            print(f"{OUTPUT_PATH} is out of date, run scripts/generate_sensor_types.py")
+            sys.exit(1)
+        return
+    OUTPUT_PATH.write_text(content)
+    print(f"Wrote {OUTPUT_PATH}")
+
+
+if __name__ == "__main__":
+    main()
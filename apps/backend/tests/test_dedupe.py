@@ -0,0 +1,29 @@
+import unittest
+
+from app.services.dedupe import WINDOW_SIZE, SequenceWindow
+
+
+class SequenceWindowTest(unittest.TestCase):
+    def test_marks_and_sees_recent_seqs(self):
+        window = SequenceWindow()
+        for seq in (10, 12, 11):
+            window.mark(seq)
+        self.assertTrue(all(window.seen(seq) for seq in (10, 11, 12)))
+        self.assertFalse(window.seen(9))
+        self.assertFalse(window.seen(13))
+
+    def test_forward_jump_past_window_resets_it(self):
+        window = SequenceWindow()
+        window.mark(5)
+        for seq in (5 + WINDOW_SIZE, 2**62, 2**63 - 1):
+            window.mark(seq)
+            self.assertEqual(window.highest, seq)
+            self.assertEqual(window.mask, 1)
+            self.assertTrue(window.seen(seq))
+        self.assertFalse(window.seen(5))
+        window.mark(2**63 - 2)
+        self.assertTrue(window.seen(2**63 - 2))
+
+
+if __name__ == "__main__":
+    unittest.main()
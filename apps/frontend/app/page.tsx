@@ -1,6 +1,6 @@
 "use client";
 
-import { useState } from "react";
+import { useEffect, useState } from "react";
 import { useSensorData } from "@/hooks/use-sensor-data";
 import { SensorCards } from "@/components/dashboard/SensorCards";
 import { SensorCharts } from "@/components/dashboard/SensorCharts";
@@ -8,9 +8,26 @@ import { Button } from "@/components/ui/button";
 import { normalizeApiUrl, getApiUrl } from "@/lib/utils";
 
 export default function Home() {
-  const { data, loading, error, refetch } = useSensorData();
+  const [deviceId, setDeviceId] = useState<string | null>(null);
+  const [devices, setDevices] = useState<string[]>([]);
+  const { data, loading, error, refetch } = useSensorData(deviceId);
   const [generating, setGenerating] = useState(false);
 
+  useEffect(() => {
+    const fetchDevices = async () => {
+      try {
+        const response = await fetch(normalizeApiUrl(getApiUrl(), "/api/devices"));
+        if (response.ok) {
+          const registered: { device_id: string }[] = await response.json();
+          setDevices(registered.map((device) => device.device_id));
+        }
+      } catch (err) {
+        console.error("Error fetching devices:", err);
+      }
+    };
+    fetchDevices();
+  }, []);
+
   const handleGenerateRandomData = async () => {
     setGenerating(true);
     try {
@@ -59,6 +76,23 @@ export default function Home() {
           >
             {generating ? "Generating..." : "Generate Random Sensor Data"}
           </Button>
+          {devices.length > 1 && (
+            <div className="mt-6">
+              <select
+                value={deviceId ?? ""}
+                onChange={(event) => setDeviceId(event.target.value || null)}
+                className="h-10 rounded-md border border-input bg-background px-3 text-sm"
+                aria-label="Device"
+              >
+                <option value="">All devices</option>
+                {devices.map((id) => (
+                  <option key={id} value={id}>
+                    {id}
+                  </option>
+                ))}
+              </select>
+            </div>
+          )}
         </div>
 
         {/* Error State */}
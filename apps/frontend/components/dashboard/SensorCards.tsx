@@ -2,12 +2,20 @@
 
 import { Card, CardContent, CardHeader, CardTitle } from "@/components/ui/card";
 import { SensorData } from "@/types/sensor";
-import { Thermometer, Droplets, Wind, Sun, Volume2, Gauge } from "lucide-react";
+import { Thermometer, Droplets, Wind, Sun, Volume2, AudioLines, Gauge } from "lucide-react";
 
 interface SensorCardsProps {
   latestData: SensorData | null;
 }
 
+// Fields are null until the board has reported them at least once
+function formatValue(value: number | null | undefined, fractionDigits?: number): string {
+  if (value === null || value === undefined) {
+    return "--";
+  }
+  return fractionDigits === undefined ? String(value) : value.toFixed(fractionDigits);
+}
+
 export function SensorCards({ latestData }: SensorCardsProps) {
   if (!latestData) {
     return (
@@ -36,7 +44,7 @@ export function SensorCards({ latestData }: SensorCardsProps) {
           </CardTitle>
         </CardHeader>
         <CardContent>
-          <div className="text-3xl font-bold">{latestData.temperature.toFixed(2)}°C</div>
+          <div className="text-3xl font-bold">{formatValue(latestData.temperature, 2)}°C</div>
         </CardContent>
       </Card>
 
@@ -48,7 +56,7 @@ export function SensorCards({ latestData }: SensorCardsProps) {
           </CardTitle>
         </CardHeader>
         <CardContent>
-          <div className="text-3xl font-bold">{latestData.humidity.toFixed(2)}%</div>
+          <div className="text-3xl font-bold">{formatValue(latestData.humidity, 2)}%</div>
         </CardContent>
       </Card>
 
@@ -60,7 +68,7 @@ export function SensorCards({ latestData }: SensorCardsProps) {
           </CardTitle>
         </CardHeader>
         <CardContent>
-          <div className="text-3xl font-bold">{latestData.voc}</div>
+          <div className="text-3xl font-bold">{formatValue(latestData.voc)}</div>
         </CardContent>
       </Card>
 
@@ -72,7 +80,7 @@ export function SensorCards({ latestData }: SensorCardsProps) {
           </CardTitle>
         </CardHeader>
         <CardContent>
-          <div className="text-3xl font-bold">{latestData.light}</div>
+          <div className="text-3xl font-bold">{formatValue(latestData.light)}</div>
           <div className="text-sm text-muted-foreground mt-1">0-4095 range</div>
         </CardContent>
       </Card>
@@ -85,11 +93,26 @@ export function SensorCards({ latestData }: SensorCardsProps) {
           </CardTitle>
         </CardHeader>
         <CardContent>
-          <div className="text-3xl font-bold">{latestData.sound}</div>
+          <div className="text-3xl font-bold">{formatValue(latestData.sound)}</div>
           <div className="text-sm text-muted-foreground mt-1">0-4095 range</div>
         </CardContent>
       </Card>
 
+      <Card className="h-full transition-shadow hover:shadow-lg">
+        <CardHeader>
+          <CardTitle className="text-xl flex items-center gap-2">
+            <AudioLines className="h-5 w-5" />
+            Sound Level
+          </CardTitle>
+        </CardHeader>
+        <CardContent>
+          <div className="text-3xl font-bold">{formatValue(latestData.sound_spectrum?.laeq_db, 1)} dB(A)</div>
+          <div className="text-sm text-muted-foreground mt-1">
+            Peak {formatValue(latestData.sound_spectrum?.peak_db, 1)} dB, {formatValue(latestData.sound_spectrum?.peak_events)} events
+          </div>
+        </CardContent>
+      </Card>
+
       <Card className="h-full transition-shadow hover:shadow-lg">
         <CardHeader>
           <CardTitle className="text-xl flex items-center gap-2">
@@ -101,21 +124,21 @@ export function SensorCards({ latestData }: SensorCardsProps) {
           <div className="space-y-2">
             <div className="flex justify-between">
               <span className="text-muted-foreground">X:</span>
-              <span className="font-semibold">{latestData.accelerometer.x.toFixed(2)}</span>
+              <span className="font-semibold">{formatValue(latestData.accelerometer?.x, 2)}</span>
             </div>
             <div className="flex justify-between">
               <span className="text-muted-foreground">Y:</span>
-              <span className="font-semibold">{latestData.accelerometer.y.toFixed(2)}</span>
+              <span className="font-semibold">{formatValue(latestData.accelerometer?.y, 2)}</span>
             </div>
             <div className="flex justify-between">
               <span className="text-muted-foreground">Z:</span>
-              <span className="font-semibold">{latestData.accelerometer.z.toFixed(2)}</span>
+              <span className="font-semibold">{formatValue(latestData.accelerometer?.z, 2)}</span>
             </div>
           </div>
         </CardContent>
       </Card>
 
-      <Card className="h-full transition-shadow hover:shadow-lg sm:col-span-2 lg:col-span-1">
+      <Card className="h-full transition-shadow hover:shadow-lg">
         <CardHeader>
           <CardTitle className="text-xl flex items-center gap-2">
             <Gauge className="h-5 w-5" />
@@ -126,15 +149,15 @@ export function SensorCards({ latestData }: SensorCardsProps) {
           <div className="space-y-2">
             <div className="flex justify-between">
               <span className="text-muted-foreground">X:</span>
-              <span className="font-semibold">{latestData.gyroscope.x.toFixed(2)}</span>
+              <span className="font-semibold">{formatValue(latestData.gyroscope?.x, 2)}</span>
             </div>
             <div className="flex justify-between">
               <span className="text-muted-foreground">Y:</span>
-              <span className="font-semibold">{latestData.gyroscope.y.toFixed(2)}</span>
+              <span className="font-semibold">{formatValue(latestData.gyroscope?.y, 2)}</span>
             </div>
             <div className="flex justify-between">
               <span className="text-muted-foreground">Z:</span>
-              <span className="font-semibold">{latestData.gyroscope.z.toFixed(2)}</span>
+              <span className="font-semibold">{formatValue(latestData.gyroscope?.z, 2)}</span>
             </div>
           </div>
         </CardContent>
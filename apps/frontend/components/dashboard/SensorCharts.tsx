@@ -1,7 +1,7 @@
 "use client";
 
 import { Card, CardContent, CardHeader, CardTitle } from "@/components/ui/card";
-import { SensorData } from "@/types/sensor";
+import { SensorData, OCTAVE_BAND_CENTERS_HZ } from "@/types/sensor";
 import {
   LineChart,
   Line,
@@ -12,6 +12,8 @@ import {
   Legend,
   ResponsiveContainer,
   ComposedChart,
+  BarChart,
+  Bar,
 } from "recharts";
 
 interface SensorChartsProps {
@@ -19,26 +21,26 @@ interface SensorChartsProps {
 }
 
 export function SensorCharts({ data }: SensorChartsProps) {
-  // Transform data for charts (reverse to show oldest first)
+  // Transform data for charts (reverse to show oldest first).
+  // Sensor fields are passed through as-is; vector axes use nested dataKeys like "accelerometer.x"
   const chartData = [...data].reverse().map((item) => ({
+    ...item,
     time: new Date(item.timestamp).toLocaleTimeString("en-US", {
       hour: "2-digit",
       minute: "2-digit",
     }),
     timestamp: new Date(item.timestamp).getTime(),
-    temperature: item.temperature,
-    humidity: item.humidity,
-    voc: item.voc,
-    light: item.light,
-    sound: item.sound,
-    accX: item.accelerometer.x,
-    accY: item.accelerometer.y,
-    accZ: item.accelerometer.z,
-    gyroX: item.gyroscope.x,
-    gyroY: item.gyroscope.y,
-    gyroZ: item.gyroscope.z,
   }));
 
+  // Octave band levels of the most recent spectrum (data is newest first)
+  const latestSpectrum = data.find((item) => item.sound_spectrum)?.sound_spectrum;
+  const bandData = latestSpectrum
+    ? OCTAVE_BAND_CENTERS_HZ.map((hz, i) => ({
+        band: hz >= 1000 ? `${hz / 1000}k` : `${hz}`,
+        level: latestSpectrum.band_levels_db[i],
+      }))
+    : [];
+
   if (data.length === 0) {
     return (
       <div className="text-center py-12 text-muted-foreground">
@@ -136,6 +138,64 @@ export function SensorCharts({ data }: SensorChartsProps) {
         </CardContent>
       </Card>
 
+      {/* Sound Level */}
+      <Card className="transition-shadow hover:shadow-lg">
+        <CardHeader>
+          <CardTitle className="text-2xl">Sound Level</CardTitle>
+        </CardHeader>
+        <CardContent>
+          <ResponsiveContainer width="100%" height={300}>
+            <LineChart data={chartData}>
+              <CartesianGrid strokeDasharray="3 3" />
+              <XAxis
+                dataKey="time"
+                tick={{ fontSize: 12 }}
+                interval="preserveStartEnd"
+              />
+              <YAxis label={{ value: "dB", angle: -90, position: "insideLeft" }} />
+              <Tooltip />
+              <Legend />
+              <Line
+                type="monotone"
+                dataKey="sound_spectrum.laeq_db"
+                stroke="#8b5cf6"
+                strokeWidth={2}
+                name="LAeq (dB(A))"
+                dot={false}
+              />
+              <Line
+                type="monotone"
+                dataKey="sound_spectrum.peak_db"
+                stroke="#f43f5e"
+                strokeWidth={2}
+                name="Peak (dB)"
+                dot={false}
+              />
+            </LineChart>
+          </ResponsiveContainer>
+        </CardContent>
+      </Card>
+
+      {/* Octave Bands */}
+      {bandData.length > 0 && (
+        <Card className="transition-shadow hover:shadow-lg">
+          <CardHeader>
+            <CardTitle className="text-2xl">Octave Bands (latest)</CardTitle>
+          </CardHeader>
+          <CardContent>
+            <ResponsiveContainer width="100%" height={300}>
+              <BarChart data={bandData}>
+                <CartesianGrid strokeDasharray="3 3" />
+                <XAxis dataKey="band" tick={{ fontSize: 12 }} label={{ value: "Hz", position: "insideBottomRight", offset: -5 }} />
+                <YAxis label={{ value: "dB", angle: -90, position: "insideLeft" }} />
+                <Tooltip />
+                <Bar dataKey="level" fill="#8b5cf6" name="Level (dB)" />
+              </BarChart>
+            </ResponsiveContainer>
+          </CardContent>
+        </Card>
+      )}
+
       {/* Accelerometer */}
       <Card className="transition-shadow hover:shadow-lg">
         <CardHeader>
@@ -155,7 +215,7 @@ export function SensorCharts({ data }: SensorChartsProps) {
               <Legend />
               <Line
                 type="monotone"
-                dataKey="accX"
+                dataKey="accelerometer.x"
                 stroke="#ff0000"
                 strokeWidth={2}
                 name="X (m/s²)"
@@ -163,7 +223,7 @@ export function SensorCharts({ data }: SensorChartsProps) {
               />
               <Line
                 type="monotone"
-                dataKey="accY"
+                dataKey="accelerometer.y"
                 stroke="#00ff00"
                 strokeWidth={2}
                 name="Y (m/s²)"
@@ -171,7 +231,7 @@ export function SensorCharts({ data }: SensorChartsProps) {
               />
               <Line
                 type="monotone"
-                dataKey="accZ"
+                dataKey="accelerometer.z"
                 stroke="#0000ff"
                 strokeWidth={2}
                 name="Z (m/s²)"
@@ -201,7 +261,7 @@ export function SensorCharts({ data }: SensorChartsProps) {
               <Legend />
               <Line
                 type="monotone"
-                dataKey="gyroX"
+                dataKey="gyroscope.x"
                 stroke="#ef4444"
                 strokeWidth={2}
                 name="X (rad/s)"
@@ -209,7 +269,7 @@ export function SensorCharts({ data }: SensorChartsProps) {
               />
               <Line
                 type="monotone"
-                dataKey="gyroY"
+                dataKey="gyroscope.y"
                 stroke="#22c55e"
                 strokeWidth={2}
                 name="Y (rad/s)"
@@ -217,7 +277,7 @@ export function SensorCharts({ data }: SensorChartsProps) {
               />
               <Line
                 type="monotone"
-                dataKey="gyroZ"
+                dataKey="gyroscope.z"
                 stroke="#3b82f6"
                 strokeWidth={2}
                 name="Z (rad/s)"
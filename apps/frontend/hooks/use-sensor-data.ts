@@ -4,7 +4,7 @@ import { useState, useEffect, useCallback } from "react";
 import { SensorData } from "@/types/sensor";
 import { normalizeApiUrl, getApiUrl } from "@/lib/utils";
 
-export function useSensorData() {
+export function useSensorData(deviceId?: string | null) {
   const [data, setData] = useState<SensorData[]>([]);
   const [loading, setLoading] = useState(true);
   const [error, setError] = useState<string | null>(null);
@@ -13,7 +13,10 @@ export function useSensorData() {
     setLoading(true);
     setError(null);
     try {
-      const apiUrl = normalizeApiUrl(getApiUrl(), "/api/sensors_data");
+      const path = deviceId
+        ? `/api/sensors_data?device_id=${encodeURIComponent(deviceId)}`
+        : "/api/sensors_data";
+      const apiUrl = normalizeApiUrl(getApiUrl(), path);
       const response = await fetch(apiUrl, {
         method: "GET",
         headers: {
@@ -33,7 +36,7 @@ export function useSensorData() {
     } finally {
       setLoading(false);
     }
-  }, []);
+  }, [deviceId]);
 
   useEffect(() => {
     fetchData();
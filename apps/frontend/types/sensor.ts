@@ -1,24 +1,57 @@
-export interface Accelerometer {
+// Generated by apps/backend/scripts/generate_sensor_types.py from the
+// SensorDataOutput model in apps/backend/app/models/sensor.py, whose sensor
+// fields come from apps/backend/app/models/registry.py. Do not edit by hand.
+
+export const OCTAVE_BAND_CENTERS_HZ = [63, 125, 250, 500, 1000, 2000, 4000, 8000] as const;
+
+export interface Vector3 {
   x: number;
   y: number;
   z: number;
 }
 
-export interface Gyroscope {
+export interface SoundSpectrum {
+  /** Energy per octave band in dB, bands centred at OCTAVE_BAND_CENTERS_HZ */
+  band_levels_db: number[];
+  /** A-weighted equivalent level, dB(A) */
+  laeq_db: number;
+  /** Highest short-term level in the window, dB */
+  peak_db: number;
+  /** Number of peaks above the device's event threshold */
+  peak_events: number;
+}
+
+export interface Quaternion {
+  w: number;
   x: number;
   y: number;
   z: number;
 }
 
 export interface SensorData {
-  id?: string;
+  id?: string | null;
+  device_id?: string | null;
   timestamp: string;
-  temperature: number;
-  humidity: number;
-  voc: number;
-  light: number;
-  sound: number;
-  accelerometer: Accelerometer;
-  gyroscope: Gyroscope;
+  device_timestamp?: string | null;
+  sample_rates_hz?: Partial<Record<string, number>> | null;
+  report_interval_s?: number | null;
+  seq?: number | null;
+  /** Temperature in Celsius */
+  temperature: number | null;
+  /** Humidity percentage */
+  humidity: number | null;
+  /** VOC index (uint32) */
+  voc: number | null;
+  /** Light sensor value (0-4095) */
+  light: number | null;
+  /** Sound sensor value (0-4095) */
+  sound: number | null;
+  /** Acceleration in m/s² */
+  accelerometer: Vector3 | null;
+  /** Angular velocity in rad/s */
+  gyroscope: Vector3 | null;
+  /** Acoustic features computed on the device from the sound ADC stream */
+  sound_spectrum: SoundSpectrum | null;
+  /** Orientation quaternion fused on the device from accelerometer and gyroscope */
+  orientation: Quaternion | null;
 }
-